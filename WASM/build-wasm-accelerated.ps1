@@ -4,6 +4,20 @@ Write-Host "Building WASM Rasterizer..." -ForegroundColor Cyan
 # Activate Emscripten
 & C:\emsdk\emsdk_env.ps1
 
+# Every export the JS side uses. The list is checked against the output after the build: a
+# missing export would otherwise only show up as a feature that silently stays off.
+$exports = @(
+    '_drawTriangle', '_clearBuffers', '_renderBatch', '_renderWireframe', '_radixSort', '_malloc',
+    '_free', '_transformBuffer', '_projectBuffer', '_processFaces', '_processFacesSIMD', '_processClusters',
+    '_extractColors', '_binFaces', '_renderTile', '_uploadClusters', '_getPixelBuffer', '_getRawVerticesBuffer',
+    '_getWorldBuffer', '_getScreenBuffer', '_getIndicesBuffer', '_getIntensitiesBuffer', '_getVertexIntensitiesBuffer', '_getFaceColorsBuffer',
+    '_getDepthsBuffer', '_getSortedIndicesBuffer', '_getAuxIndicesBuffer', '_getAuxDepthsBuffer', '_getRadixCountsBuffer', '_getMatrixBuffer',
+    '_getTilesBuffer', '_getOutFBBuffer', '_processClustersOccluded', '_buildDepthPyramid', '_getOcclusionStats', '_getDepthPyramidBuffer',
+    '_buildBVH', '_refitBVH', '_bvhRaycast', '_bvhSelectBox', '_bvhSnapVertex', '_getPickResultBuffer',
+    '_getSelectionRangesBuffer', '_getOutFBPlane', '_upscaleColors', '_renderRegion', '_setDebug', '_getStageScreen',
+    '_getStageDepths', '_getStageSortedIndices', '_getStageIntensities', '_getStageFaceColors'
+)
+
 # Build command using script-relative paths
 emcc "$PSScriptRoot\..\js\core\wasm\rasterizer.cpp" `
     -o "$PSScriptRoot\..\js\core\wasm\rasterizer_v2.js" `
@@ -15,21 +29,30 @@ emcc "$PSScriptRoot\..\js\core\wasm\rasterizer.cpp" `
     -s WASM=1 `
     -s SHARED_MEMORY=1 `
     -s INITIAL_MEMORY=536870912 `
-    -s EXPORTED_FUNCTIONS="['_drawTriangle','_clearBuffers','_renderBatch','_renderWireframe','_radixSort','_malloc','_free','_transformBuffer','_projectBuffer','_processFaces','_processFacesSIMD','_processClusters','_extractColors','_binFaces','_renderTile','_uploadClusters','_getPixelBuffer','_getRawVerticesBuffer','_getWorldBuffer','_getScreenBuffer','_getIndicesBuffer','_getIntensitiesBuffer','_getVertexIntensitiesBuffer','_getFaceColorsBuffer','_getDepthsBuffer','_getSortedIndicesBuffer','_getAuxIndicesBuffer','_getAuxDepthsBuffer','_getRadixCountsBuffer','_getMatrixBuffer','_getTilesBuffer','_getOutFBBuffer']" `
-    -s EXPORTED_RUNTIME_METHODS="['HEAPU8']"
+    -s EXPORTED_FUNCTIONS="[$(($exports | ForEach-Object { "'$_'" }) -join ',')]" `
+    -s EXPORTED_RUNTIME_METHODS="['HEAPU8','stackRestore']"
 
-if ($LASTEXITCODE -eq 0) {
-    Write-Host ""
-    Write-Host "[SUCCESS] WASM build complete!" -ForegroundColor Green
-    Write-Host ""
-    Write-Host "Output files:" -ForegroundColor Cyan
-    Get-ChildItem "$PSScriptRoot\..\js\core\wasm\*.wasm" | ForEach-Object {
-        $sizeKB = [math]::Round($_.Length / 1KB, 2)
-        Write-Host "  - $($_.Name) ($sizeKB KB)" -ForegroundColor Gray
-    }
-}
-else {
+if ($LASTEXITCODE -ne 0) {
     Write-Host "[ERROR] Build failed" -ForegroundColor Red
+    exit 1
+}
+
+# Post-build check: every export must be present in the generated glue
+$glue = Get-Content "$PSScriptRoot\..\js\core\wasm\rasterizer_v2.js" -Raw
+$missing = @($exports | Where-Object { -not $glue.Contains("`"$_`"") })
+if ($missing.Count -gt 0) {
+    Write-Host "[ERROR] Build output lacks exports: $($missing -join ', ')" -ForegroundColor Red
+    exit 1
+}
+
+Write-Host ""
+Write-Host "[SUCCESS] WASM build complete! ($($exports.Count) exports verified)" -ForegroundColor Green
+Write-Host ""
+Write-Host "Output files:" -ForegroundColor Cyan
+Get-ChildItem "$PSScriptRoot\..\js\core\wasm\*.wasm" | ForEach-Object {
+    $sizeKB = [math]::Round($_.Length / 1KB, 2)
+    Write-Host "  - $($_.Name) ($sizeKB KB)" -ForegroundColor Gray
 }
+Write-Host "Commit rasterizer_v2.js and rasterizer_v2.wasm together with rasterizer.cpp." -ForegroundColor Gray
 
 # No pause needed for automated runs
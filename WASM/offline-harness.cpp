@@ -0,0 +1,254 @@
+// VEETANCE Offline Harness
+// Native checks and benchmark for the offline region renderer (renderRegion / renderOffline / PPM sink).
+//
+// Build (from the repo root; SIMDe supplies the wasm_* intrinsics):
+//   g++ -O2 -std=c++17 -I<simde-include-dir> WASM/offline-harness.cpp -o offline-harness
+// Run:
+//   ./offline-harness            checks, exit code 0 = pass
+//   ./offline-harness --bench    8K still (7680x4320) of a ~1M-face sphere through renderOffline + PPM
+//
+// Checks:
+//   1. Tiling: a mosaic of tile-aligned regions equals one single-region render (SOLID, WIRE,
+//      SHADED_WIRE, NORMALS), bit for bit, and so does the render without cluster culling.
+//   2. Offline + PPM: renderOffline streamed through the PPM sink, read back, equals a mosaic
+//      rendered with a different region size.
+//   3. Coordinates beyond 32768 px: a region at x >= 32768 equals the same view rendered near the
+//      origin (only the principal point differs), up to float rounding of the screen positions.
+//   4. A sink that fails stops renderOffline, which reports -1.
+
+#include "../js/core/wasm/rasterizer.cpp"
+#include <chrono>
+#include <vector>
+
+enum Mode { SOLID, WIRE, SHADED_WIRE, NORMALS };
+static const char* MODE_NAMES[] = { "SOLID", "WIRE", "SHADED_WIRE", "NORMALS" };
+
+static const uint32_t BASE_COLOR = 0xFF808080;
+static const uint32_t WIRE_COLOR = 0xFFD2FF00;
+static const int CLUSTER_FACES = 128;
+
+struct Mesh {
+    int vCount, fCount;
+};
+
+// UV sphere (radius 1) written straight into the resident buffers, faces in ring order, with
+// CLUSTER_FACES-face clusters so renderRegion takes the cluster path like a loaded model.
+static Mesh buildSphere(int segments, int rings) {
+    float* v = getRawVerticesBuffer();
+    uint32_t* idx = getIndicesBuffer();
+    Mesh mesh = { 0, 0 };
+    for (int r = 0; r <= rings; r++) {
+        for (int s = 0; s <= segments; s++) {
+            float th = (float)M_PI * r / rings, ph = 2.0f * (float)M_PI * s / segments;
+            v[mesh.vCount * 3] = sinf(th) * cosf(ph);
+            v[mesh.vCount * 3 + 1] = cosf(th);
+            v[mesh.vCount * 3 + 2] = sinf(th) * sinf(ph);
+            mesh.vCount++;
+        }
+    }
+    for (int r = 0; r < rings; r++) {
+        for (int s = 0; s < segments; s++) {
+            uint32_t a = r * (segments + 1) + s, b = a + 1, c = a + segments + 1, d = c + 1;
+            uint32_t* f = &idx[mesh.fCount * 3];
+            f[0] = a; f[1] = c; f[2] = b; f[3] = b; f[4] = c; f[5] = d;
+            mesh.fCount += 2;
+        }
+    }
+
+    std::vector<Cluster> clusters;
+    for (int first = 0; first < mesh.fCount; first += CLUSTER_FACES) {
+        Cluster cl;
+        cl.startFace = first;
+        cl.faceCount = std::min(CLUSTER_FACES, mesh.fCount - first);
+        for (int k = 0; k < 3; k++) { cl.aabb[k] = 3.4e38f; cl.aabb[k + 3] = -3.4e38f; }
+        for (uint32_t i = first * 3; i < (first + cl.faceCount) * 3; i++) {
+            const float* p = &v[idx[i] * 3];
+            for (int k = 0; k < 3; k++) {
+                cl.aabb[k] = std::min(cl.aabb[k], p[k]);
+                cl.aabb[k + 3] = std::max(cl.aabb[k + 3], p[k]);
+            }
+        }
+        float dx = cl.aabb[3] - cl.aabb[0], dy = cl.aabb[4] - cl.aabb[1], dz = cl.aabb[5] - cl.aabb[2];
+        for (int k = 0; k < 3; k++) cl.sphere[k] = (cl.aabb[k] + cl.aabb[k + 3]) * 0.5f;
+        cl.sphere[3] = 0.5f * sqrtf(dx * dx + dy * dy + dz * dz);
+        clusters.push_back(cl);
+    }
+    uploadClusters(clusters.data(), (int)clusters.size());
+    return mesh;
+}
+
+static float fovScale(int height) {
+    return (height / 2) / tanf(30.0f * (float)M_PI / 180.0f); // 60 degree vertical FOV, as the viewport
+}
+
+struct View {
+    float m[16];
+    float lx, ly, lz;
+};
+
+static View makeView(float x, float y, float z) {
+    View view = { { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, x, y, z, 1 }, 0.2f, 0.3f, 1.0f };
+    float n = sqrtf(view.lx * view.lx + view.ly * view.ly + view.lz * view.lz);
+    view.lx /= n; view.ly /= n; view.lz /= n;
+    return view;
+}
+
+static int region(View& view, const Mesh& mesh, Mode mode, int outW, int outH, int x, int y, int w, int h, uint32_t* out, int outStride,
+                  bool useClusters = true) {
+    return renderRegion(view.m, mesh.vCount, mesh.fCount, useClusters, outW, outH, x, y, w, h, fovScale(outH),
+                        view.lx, view.ly, view.lz, mode == WIRE, false, mode == NORMALS, mode == SHADED_WIRE,
+                        BASE_COLOR, WIRE_COLOR, out, outStride);
+}
+
+// Assembles an outW x outH image from regionW x regionH regions (row-major, like renderOffline)
+static void mosaic(View& view, const Mesh& mesh, Mode mode, int outW, int outH, int regionW, int regionH, std::vector<uint32_t>& img) {
+    img.assign((size_t)outW * outH, 0);
+    for (int y = 0; y < outH; y += regionH) {
+        for (int x = 0; x < outW; x += regionW) {
+            region(view, mesh, mode, outW, outH, x, y, std::min(regionW, outW - x), std::min(regionH, outH - y),
+                   &img[(size_t)y * outW + x], outW);
+        }
+    }
+}
+
+static int countDiff(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    int diff = 0;
+    for (size_t i = 0; i < a.size(); i++) diff += a[i] != b[i];
+    return diff;
+}
+
+static int countLit(const std::vector<uint32_t>& a) {
+    int lit = 0;
+    for (size_t i = 0; i < a.size(); i++) lit += a[i] != 0;
+    return lit;
+}
+
+static bool readPPM(const char* path, int width, int height, std::vector<uint32_t>& img) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    int w = 0, h = 0, maxVal = 0;
+    bool ok = fscanf(f, "P6 %d %d %d", &w, &h, &maxVal) == 3 && fgetc(f) == '\n' && w == width && h == height && maxVal == 255;
+    std::vector<uint8_t> rgb((size_t)width * height * 3);
+    ok = ok && fread(rgb.data(), 1, rgb.size(), f) == rgb.size();
+    fclose(f);
+    img.resize((size_t)width * height);
+    for (size_t i = 0; ok && i < img.size(); i++) {
+        img[i] = 0xFF000000 | (rgb[i * 3 + 2] << 16) | (rgb[i * 3 + 1] << 8) | rgb[i * 3];
+    }
+    return ok;
+}
+
+// Background is transparent black in the framebuffer and opaque black in the PPM
+static void opaque(std::vector<uint32_t>& img) {
+    for (size_t i = 0; i < img.size(); i++) img[i] |= 0xFF000000;
+}
+
+static bool check(bool ok, const char* what) {
+    printf("%s  %s\n", ok ? "PASS" : "FAIL", what);
+    return ok;
+}
+
+static int runChecks() {
+    char line[160];
+    bool ok = true;
+    Mesh mesh = buildSphere(200, 100);
+    View view = makeView(0.2f, -0.1f, -2.5f); // Slightly off-centre
+
+    // 1. Tile-aligned mosaic vs single-region render
+    const int W = 1200, H = 900;
+    for (int mode = SOLID; mode <= NORMALS; mode++) {
+        std::vector<uint32_t> single((size_t)W * H), flat((size_t)W * H), tiled;
+        int faces = region(view, mesh, (Mode)mode, W, H, 0, 0, W, H, single.data(), W);
+        region(view, mesh, (Mode)mode, W, H, 0, 0, W, H, flat.data(), W, false);
+        mosaic(view, mesh, (Mode)mode, W, H, 384, 256, tiled);
+        int diff = countDiff(single, tiled), flatDiff = countDiff(single, flat);
+        snprintf(line, sizeof(line), "tiling %-11s %d faces, %d lit px, %d px differ, %d unclustered", MODE_NAMES[mode], faces, countLit(single), diff, flatDiff);
+        ok &= check(faces > 0 && diff == 0 && flatDiff == 0, line);
+    }
+
+    // 2. renderOffline + PPM sink (ragged 3x3 regions) vs a 1024x1024 mosaic
+    const int OW = 6000, OH = 3400;
+    const char* path = "offline-harness.ppm";
+    PPMSink* sink = openPPMSink(path, OW, OH);
+    if (!check(sink != nullptr, "open PPM sink")) return 1;
+    int faces = renderOffline(view.m, mesh.vCount, mesh.fCount, true, OW, OH, fovScale(OH), view.lx, view.ly, view.lz,
+                              false, false, false, true, BASE_COLOR, WIRE_COLOR, ppmSinkRow, sink);
+    bool written = closePPMSink(sink);
+    std::vector<uint32_t> streamed, reference;
+    bool read = written && readPPM(path, OW, OH, streamed);
+    mosaic(view, mesh, SHADED_WIRE, OW, OH, 1024, 1024, reference);
+    opaque(reference);
+    int diff = read ? countDiff(streamed, reference) : -1;
+    snprintf(line, sizeof(line), "renderOffline %dx%d -> PPM: %d faces, %s, %d px differ", OW, OH, faces, written ? "written" : "WRITE FAILED", diff);
+    ok &= check(read && faces > 0 && diff == 0, line);
+    remove(path);
+
+    // 3. Beyond 32768 px: the sphere at the centre of a 120000 px wide image, seen through the
+    //    tile-aligned region around x = 60000, vs the same sphere in a small image. Only the
+    //    (integer) principal point differs.
+    const int BW = 120000, SW = 1280, RH = 768, RW = 1280;
+    View centred = makeView(0.0f, 0.0f, -2.5f);
+    std::vector<uint32_t> wide((size_t)RW * RH), small((size_t)RW * RH);
+    int rx = (BW / 2 - RW / 2) / TILE_SIZE * TILE_SIZE;
+    region(centred, mesh, SOLID, BW, RH, rx, 0, RW, RH, wide.data(), RW);
+    region(centred, mesh, SOLID, SW, RH, 0, 0, RW, RH, small.data(), RW);
+    // Shift the small image by the sub-tile offset: image centres are BW/2 - rx vs SW/2 in each region
+    int shift = (BW / 2 - rx) - SW / 2;
+    int lit = 0, mismatch = 0;
+    for (int y = 0; y < RH; y++) {
+        for (int x = 0; x < RW; x++) {
+            int sx = x - shift;
+            uint32_t a = wide[(size_t)y * RW + x], b = (sx >= 0 && sx < RW) ? small[(size_t)y * RW + sx] : 0;
+            lit += a != 0;
+            mismatch += (a != 0) != (b != 0); // Coverage; shading may differ by one step at float rounding
+        }
+    }
+    snprintf(line, sizeof(line), "region at x=%d of %d px: %d lit px, %d coverage mismatches", rx, BW, lit, mismatch);
+    ok &= check(lit > 100000 && mismatch * 1000 <= lit, line);
+
+    // 4. Sink failure (e.g. disk full) aborts the render instead of streaming on
+    struct FailingSink {
+        int rows;
+        static bool row(void* user, int, int, int, const uint32_t*) { return ++((FailingSink*)user)->rows < 10; }
+    } failing = { 0 };
+    faces = renderOffline(view.m, mesh.vCount, mesh.fCount, true, OW, OH, fovScale(OH), view.lx, view.ly, view.lz,
+                          false, false, false, false, BASE_COLOR, WIRE_COLOR, FailingSink::row, &failing);
+    snprintf(line, sizeof(line), "failing sink: renderOffline returned %d after %d rows", faces, failing.rows);
+    ok &= check(faces == -1 && failing.rows == 10, line);
+
+    printf(ok ? "All checks passed.\n" : "Checks FAILED.\n");
+    return ok ? 0 : 1;
+}
+
+static int runBench() {
+    Mesh mesh = buildSphere(1000, 500);
+    View view = makeView(0.0f, 0.0f, -2.5f);
+    const int W = 7680, H = 4320, RUNS = 3;
+    const char* path = "offline-bench.ppm";
+    printf("Sphere: %d vertices, %d faces. Still %dx%d (%d regions)\n", mesh.vCount, mesh.fCount, W, H,
+           ((W + REGION_WIDTH - 1) / REGION_WIDTH) * ((H + REGION_HEIGHT - 1) / REGION_HEIGHT));
+    double best = 1e30;
+    for (int run = 0; run < RUNS; run++) {
+        PPMSink* sink = openPPMSink(path, W, H);
+        if (!sink) { printf("Cannot open %s\n", path); return 1; }
+        auto t0 = std::chrono::steady_clock::now();
+        int faces = renderOffline(view.m, mesh.vCount, mesh.fCount, true, W, H, fovScale(H), view.lx, view.ly, view.lz,
+                                  false, false, false, true, BASE_COLOR, WIRE_COLOR, ppmSinkRow, sink);
+        if (!closePPMSink(sink) || faces < 0) {
+            printf("Writing %s failed\n", path);
+            remove(path);
+            return 1;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        best = std::min(best, ms);
+        printf("run %d: %d faces in %.0f ms (%.1f Mpx/s, PPM included)\n", run + 1, faces, ms, W * (double)H / ms / 1000.0);
+    }
+    printf("best: %.0f ms\n", best);
+    remove(path);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) return runBench();
+    return runChecks();
+}
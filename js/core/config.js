@@ -9,6 +9,12 @@ window.ENGINE.Config = {
     MAX_FACES: 1500000,
 
     // Rendering
+    FB_WIDTH: 2560,   // Tiled framebuffer capacity (must match rasterizer.cpp)
+    FB_HEIGHT: 1600,
+    REGION_WIDTH: 2560,  // Offline/still regions: framebuffer rounded down to the 128 px tile grid
+    REGION_HEIGHT: 1536,
+    PRESENT_MAX_WIDTH: 3840, // Presentation plane capacity for upscaled frames
+    PRESENT_MAX_HEIGHT: 2160,
     DEFAULT_FOV: 60,
     Z_OFFSET: 5,
     GRID_SIZE: 10,
@@ -143,7 +143,14 @@ window.ENGINE.Core = (function () {
     let lastBudget = 0;
     let lastVerts = null;
     let wasWASMReady = false;
+    let lastPipelineFrame = -1;
     let isRendering = false;
+    let lastStill = null; // Region-rendered still on screen (sync path): { key, vertices, indices }
+
+    // A still beyond the framebuffer costs several region passes: identical ones are drawn once
+    function stillKey(job) {
+        return `${job.matrix.join()}|${job.width}x${job.height}|${job.fov}|${job.viewMode}|${job.baseColor}|${job.wireColor}`;
+    }
 
     async function frame(mainCtx, overlayCtx, canvas, loop = true) {
         if (isRendering) return;
@@ -335,65 +342,80 @@ window.ENGINE.Core = (function () {
                 store.dispatch({ type: 'SET_MODEL_REVEAL_SCALE', payload: newLinear });
             }
 
-            // GATE: Render geometry during crossfade (phase 1) and after (phase 2)
-            const canRenderGeometry = loadingPhase >= 1;
-
-            if (useWASM && config.viewMode !== 'POINTS' && canRenderGeometry) {
+            // GATE: Render geometry during crossfade (phase 1) and after (phase 2).
+            // An offline still owns the WASM heap buffers while it runs.
+            const Offline = window.ENGINE.OfflineRenderer;
+            const offlineBusy = !!(Offline && Offline.isActive());
+            const canRenderGeometry = loadingPhase >= 1 && !offlineBusy;
+
+            // DYNAMIC RESOLUTION: WASM paths rasterize at rw x rh into the tiled framebuffer and
+            // upscale on present. POINTS and the overlays stay at canvas resolution.
+            const Scaler = window.ENGINE.ResolutionScaler;
+            const raster = Scaler ? Scaler.resolve(mTotal, canvas.width, canvas.height, config, useWASM && WASM.hasOfflineRender())
+                : { scale: 1, width: canvas.width, height: canvas.height, regions: false };
+            const rw = raster.width, rh = raster.height, rFov = fovScale * raster.scale;
+
+            const Pipeline = window.ENGINE.FramePipeline;
+            const usePipeline = useWASM && config.pipelined && Pipeline && Pipeline.isReady();
+            let pipelineSubmitted = false;
+
+            // One frame description for both WASM paths (see wasm/frame-core.js)
+            const isWire = config.viewMode === 'WIRE';  // Only pure WIRE skips backface culling
+            const frameJob = useWASM && config.viewMode !== 'POINTS' && canRenderGeometry ? {
+                matrix: Float32Array.from(mTotal),
+                width: rw, height: rh, fov: rFov,
+                lightDir: [lightDir[0], lightDir[1], lightDir[2]],
+                viewMode: config.viewMode, isWire,
+                isUV: config.viewMode === 'UV' || config.viewMode === 'NORMALS',
+                baseColor: WASM.packPolyColor(config.polyColor),
+                wireColor: WASM.packWireColor(config.fg || '#00ffd2'),
+                wireDensity: config.wireDensity !== undefined ? config.wireDensity : 1.0,
+                useOcclusion: !!(config.occlusionCulling && !isWire && object.clusters && object.clusters.length > 1 && WASM.hasOcclusionCulling()),
+                vCount, fCount,
+                regions: raster.regions, // Still beyond the framebuffer: assembled from regions at rw x rh
+                useClusters: !!(object.clusters && object.clusters.length > 0) // Uploaded with the model (uploadFrameModel)
+            } : null;
+            if (frameJob && frameJob.regions) frameJob.stillKey = stillKey(frameJob);
+
+            if (frameJob && usePipeline) {
+                // PIPELINED: geometry, raster and presentation run on their own workers, one
+                // frame apart. The main thread only describes the frame.
+                const fitsPresent = WASM.hasUpscale() && canvas.width <= window.ENGINE.Config.PRESENT_MAX_WIDTH && canvas.height <= window.ENGINE.Config.PRESENT_MAX_HEIGHT;
+                // Upscale target; beyond plane capacity the present canvas is CSS-stretched instead
+                frameJob.presentWidth = fitsPresent ? canvas.width : rw;
+                frameJob.presentHeight = fitsPresent ? canvas.height : rh;
+                pipelineSubmitted = Pipeline.submit(frameJob, { vertices, indices, clusters: object.clusters });
+                const pipeStats = Pipeline.getStats();
+                if (Scaler && pipeStats.frames !== lastPipelineFrame) {
+                    lastPipelineFrame = pipeStats.frames;
+                    Scaler.report(Math.max(pipeStats.geometryMs, pipeStats.rasterMs, pipeStats.presentMs), config);
+                }
+            } else if (frameJob) {
+                const tRaster = performance.now();
                 const forceSync = !wasWASMReady;
                 if (forceSync) wasWASMReady = true;
 
-                // Force data sync when model changes 
+                // Model identity (shared with the POINTS resample cache)
                 const modelChanged = lastVerts !== vertices || (lastVerts && lastVerts.length !== vertices.length);
-                if (modelChanged || forceSync) {
-                    lastVerts = vertices;
-                    if (object.clusters) WASM.uploadClusters(object.clusters);
-                }
-                // ALWAYS upload indices to ensure they're synced
-                WASM.uploadIndices(indices);
-
-                const isWire = config.viewMode === 'WIRE';  // Only pure WIRE skips backface culling
-                const isUV = config.viewMode === 'UV' || config.viewMode === 'NORMALS';
-
-                // mViewModel = mView * mModel (Calculated above)
-                WASM.processVertices(vertices, mTotal, vCount);
-                WASM.project(vCount, canvas.width, canvas.height, fovScale);
-
-                let validFaces = 0;
-                if (false && object.clusters && object.clusters.length > 1 && fCount > 500000) {
-                    // DISABLED: processClusters has issues, using processFaces for all models
-                    validFaces = WASM.processClusters(mTotal, fCount, lightDir, isWire, isUV, canvas.width, canvas.height);
-                } else {
-                    validFaces = WASM.processFaces(fCount, lightDir, isWire, canvas.width, canvas.height, config.viewMode);
-                }
-
-
-                if (validFaces > 0) {
-                    const sorted = WASM.sortFaces(validFaces);
-                    const isPixelPath = config.viewMode === 'SOLID' || config.viewMode === 'SHADED_WIRE' || config.viewMode === 'UV' || config.viewMode === 'WIRE' || config.viewMode === 'NORMALS';
-                    if (isPixelPath) {
-                        WASM.clearHW(canvas.width, canvas.height);
-                        if (isWire) {
-                            const rawColor = config.fg || '#00ffd2';
-                            const wasmColor = typeof rawColor === 'string' ?
-                                (0xFF000000 | (parseInt(rawColor.slice(5, 7), 16) << 16) | (parseInt(rawColor.slice(3, 5), 16) << 8) | parseInt(rawColor.slice(1, 3), 16)) :
-                                rawColor;
-                            const density = config.wireDensity !== undefined ? config.wireDensity : 1.0;
-                            WASM.renderWire(validFaces, wasmColor, canvas.width, canvas.height, density);
-                        } else {
-                            await WASM.render(mainCtx, validFaces, config, canvas.width, canvas.height, isUV);
-                            // Add wireframe overlay for SHADED_WIRE mode
-                            if (config.viewMode === 'SHADED_WIRE') {
-                                const rawColor = config.fg || '#00ffd2';
-                                const wasmColor = typeof rawColor === 'string' ?
-                                    (0xFF000000 | (parseInt(rawColor.slice(5, 7), 16) << 16) | (parseInt(rawColor.slice(3, 5), 16) << 8) | parseInt(rawColor.slice(1, 3), 16)) :
-                                    rawColor;
-                                const density = config.wireDensity !== undefined ? config.wireDensity : 1.0;
-                                WASM.renderWire(validFaces, wasmColor, canvas.width, canvas.height, density);
-                            }
-                        }
-                        WASM.flush(mainCtx, canvas.width, canvas.height);
+                if (modelChanged || forceSync) lastVerts = vertices;
+                // Same upload rule as the pipeline: vertices every frame, topology by residency
+                WASM.uploadFrameModel({ vertices, indices, clusters: object.clusters });
+
+                if (raster.regions) {
+                    if (lastStill && lastStill.key === frameJob.stillKey && lastStill.vertices === vertices && lastStill.indices === indices) {
+                        WASM.redraw(mainCtx, canvas.width, canvas.height);
+                    } else if (WASM.renderStill(frameJob) > 0) {
+                        WASM.present(mainCtx, rw, rh, canvas.width, canvas.height);
+                        lastStill = { key: frameJob.stillKey, vertices, indices };
+                    } else {
+                        lastStill = null;
                     }
+                } else {
+                    lastStill = null;
+                    const validFaces = WASM.renderFrame(frameJob);
+                    if (validFaces > 0) WASM.flush(mainCtx, canvas.width, canvas.height, rw, rh);
                 }
+                if (Scaler) Scaler.report(performance.now() - tRaster, config);
             } else if (config.viewMode === 'POINTS' && canRenderGeometry) {
                 // --- JS POINTS PATH (Only mode that works without WASM) ---
                 MathOps.transformBuffer(buffers.world, vertices, mTotal, vCount);
@@ -417,6 +439,7 @@ window.ENGINE.Core = (function () {
             }
             // WASM not ready and not POINTS mode - skip geometry rendering
             // (Grid and Gizmos still render)
+            if (Pipeline && !pipelineSubmitted && !offlineBusy) Pipeline.clear(); // Keep the last frame up during offline stills
 
             // --- GIZMOS ---
             const GR = window.ENGINE.GizmoRenderer;
@@ -446,5 +469,9 @@ window.ENGINE.Core = (function () {
         }
     }
 
-    return { frame, update: (mainCtx, overlayCtx, canvas) => frame(mainCtx, overlayCtx, canvas, false) };
+    return {
+        frame,
+        update: (mainCtx, overlayCtx, canvas) => frame(mainCtx, overlayCtx, canvas, false),
+        getViewModelMatrix: () => mTotal // Last rendered model-view (picking queries)
+    };
 })();
@@ -0,0 +1,231 @@
+/**
+ * VEETANCE Frame Pipeline
+ * Pipelined WASM frames in three stages, each on its own worker:
+ *   geometry (transform → project → cull → sort) of frame N+2, into one of two stage sets
+ *   raster (bin → tiles → wire) of frame N+1, from the other stage set
+ *   present (OffscreenCanvas) of frame N, from one of two colour planes
+ * The main thread only submits jobs and handles input.
+ */
+window.ENGINE = window.ENGINE || {};
+window.ENGINE.FramePipeline = (function () {
+    const STACK_SIZE = 1 << 20; // Private C stack per worker module instance
+
+    let geometryWorker = null, frameWorker = null, presentWorker = null;
+    let isInitialized = false;
+    let geometryBusy = false;   // Geometry worker has a job
+    let inFlight = 0;           // Frames dispatched whose raster stage has not finished
+    let holds = 0;              // whenIdle() callers still using the heap: nothing dispatches
+    let pending = null;
+    let planeLocks = null;
+    let seq = 0, presentedSeq = -1, lastClearSeq = -1;
+    let shownStill = null; // Last dispatched job was this region still: { key, vertices, indices }
+    let stats = { geometryMs: 0, rasterMs: 0, presentMs: 0, dropped: 0, frames: 0 };
+
+    function waitReady(worker) {
+        return new Promise((resolve) => {
+            const timeout = setTimeout(() => resolve(false), 5000);
+            worker.onmessage = (e) => {
+                if (e.data.action === 'READY') {
+                    clearTimeout(timeout);
+                    resolve(true);
+                }
+            };
+        });
+    }
+
+    /**
+     * Transfers the present canvas to a worker and boots the geometry and frame workers.
+     * Falls back silently (isReady() stays false) when isolation, OffscreenCanvas
+     * or the pipelined WASM exports are unavailable. Builds without stage sets run every
+     * frame end to end on the frame worker (presentation still overlaps).
+     */
+    async function init(presentCanvas) {
+        if (isInitialized || !presentCanvas) return;
+        const WASM = window.ENGINE.RasterizerWASM;
+        if (!window.crossOriginIsolated || !presentCanvas.transferControlToOffscreen) {
+            console.warn("[DEUS] Pipelined frames unavailable: isolation or OffscreenCanvas missing.");
+            return;
+        }
+        const ctxData = WASM && await WASM.getPipelineContext();
+        if (!ctxData) {
+            console.warn("[DEUS] Pipelined frames unavailable: WASM build lacks plane/stack exports.");
+            return;
+        }
+
+        const locks = new SharedArrayBuffer(8); // One Int32 per colour plane
+        planeLocks = new Int32Array(locks);
+        const stageLocks = new SharedArrayBuffer(8); // One Int32 per stage set
+        const channel = new MessageChannel();
+        const stageChannel = ctxData.ptrs.stages ? new MessageChannel() : null;
+        const stackTop = () => (WASM.malloc(STACK_SIZE) + STACK_SIZE) & ~15;
+
+        presentWorker = new Worker('./js/core/wasm/present-worker.js');
+        const offscreen = presentCanvas.transferControlToOffscreen();
+        const presentReady = waitReady(presentWorker);
+        presentWorker.postMessage({
+            action: 'INIT',
+            data: { canvas: offscreen, sharedMemory: ctxData.sharedMemory, planes: ctxData.planes, locks, framePort: channel.port2 }
+        }, [offscreen, channel.port2]);
+
+        frameWorker = new Worker('./js/core/wasm/frame-worker.js');
+        const frameReady = waitReady(frameWorker);
+        frameWorker.postMessage({
+            action: 'INIT',
+            data: {
+                wasmJsUrl: ctxData.wasmJsUrl, wasmBinary: ctxData.wasmBinary, sharedMemory: ctxData.sharedMemory,
+                ptrs: ctxData.ptrs, planes: ctxData.planes, locks, stageLocks, presentPort: channel.port1,
+                geometryPort: stageChannel && stageChannel.port2, stackTop: stackTop()
+            }
+        }, stageChannel ? [channel.port1, stageChannel.port2] : [channel.port1]);
+
+        let geometryReady = Promise.resolve(true);
+        if (stageChannel) {
+            geometryWorker = new Worker('./js/core/wasm/geometry-worker.js');
+            geometryReady = waitReady(geometryWorker);
+            geometryWorker.postMessage({
+                action: 'INIT',
+                data: {
+                    wasmJsUrl: ctxData.wasmJsUrl, wasmBinary: ctxData.wasmBinary, sharedMemory: ctxData.sharedMemory,
+                    ptrs: ctxData.ptrs, stageLocks, rasterPort: stageChannel.port1, stackTop: stackTop()
+                }
+            }, [stageChannel.port1]);
+        }
+
+        const [okPresent, okFrame, okGeometry] = await Promise.all([presentReady, frameReady, geometryReady]);
+        if (!okPresent || !okFrame || !okGeometry) {
+            console.error("[DEUS] Pipelined frame workers failed to start.");
+            presentWorker.terminate(); frameWorker.terminate();
+            if (geometryWorker) geometryWorker.terminate();
+            return;
+        }
+
+        frameWorker.onmessage = (e) => {
+            if (e.data.action !== 'FRAME_DONE') return;
+            stats.rasterMs = e.data.ms;
+            if (e.data.serial) stats.geometryMs = 0; // Unsplit frame: rasterMs covers all of it
+            stats.frames++;
+            inFlight--;
+            pump();
+        };
+        if (geometryWorker) {
+            geometryWorker.onmessage = (e) => {
+                if (e.data.action !== 'GEOMETRY_DONE') return;
+                stats.geometryMs = e.data.ms;
+                geometryBusy = false;
+                pump();
+            };
+        }
+        presentWorker.onmessage = (e) => {
+            if (e.data.action === 'PRESENTED') stats.presentMs = e.data.ms;
+        };
+
+        isInitialized = true;
+        console.log(`[DEUS] Pipelined frames active (${geometryWorker ? 'geometry | raster | present' : 'frame | present'} workers). 🦾`);
+    }
+
+    // Split frames: geometry worker → frame worker. Two-phase occlusion (phase 2 culls against
+    // phase 1's raster) and region stills run end to end on the frame worker instead.
+    function isSplit(job) {
+        return !!geometryWorker && !job.useOcclusion && !job.regions;
+    }
+
+    /**
+     * Whether job can start now. The geometry stage only writes the matrix, world and its own
+     * stage set, and may upload vertices (the raster stage reads projected positions only).
+     * Everything else (unsplit frames, index/cluster uploads the raster stage reads) needs all
+     * workers idle.
+     */
+    function canDispatch(job, model) {
+        if (holds > 0 || geometryBusy) return false;
+        if (inFlight === 0) return true;
+        const resident = window.ENGINE.RasterizerWASM.getResident();
+        const topologyResident = model.indices === resident.indices &&
+            (!model.clusters || model.clusters.length === 0 || model.clusters === resident.clusters);
+        return isSplit(job) && topologyResident;
+    }
+
+    function pump() {
+        if (!pending || !canDispatch(pending.job, pending.model)) return;
+        const next = pending;
+        pending = null;
+        dispatch(next.job, next.model);
+    }
+
+    // Heap writes only happen here, i.e. while no stage reads what they overwrite (canDispatch).
+    // Same rule as the sync path (uploadFrameModel): vertices every frame, so in-place edits
+    // reach the pipeline; indices and clusters by residency, which also sees other heap users.
+    function dispatch(job, model) {
+        window.ENGINE.RasterizerWASM.uploadFrameModel(model);
+        shownStill = job.stillKey ? { key: job.stillKey, vertices: model.vertices, indices: model.indices } : null;
+        job.seq = seq++;
+        presentedSeq = job.seq;
+        inFlight++;
+        if (isSplit(job)) {
+            geometryBusy = true;
+            geometryWorker.postMessage({ action: 'GEOMETRY', data: job });
+        } else {
+            frameWorker.postMessage({ action: 'FRAME', data: job });
+        }
+    }
+
+    /**
+     * Queues a frame. If it cannot start yet, the newest job replaces any queued one
+     * (mailbox), so latency stays bounded. Geometry, raster and presentation of consecutive
+     * frames overlap, so frame time is max(geometry, raster, present) rather than their sum.
+     * @param {Object} job - matrix, viewport, fov, light and view-mode flags
+     * @param {{vertices, indices, clusters}} model - resident geometry (uploaded on change)
+     */
+    function submit(job, model) {
+        if (!isInitialized) return false;
+        // Region stills (job.stillKey) cost several passes: skip one that is already on screen
+        if (job.stillKey && shownStill && shownStill.key === job.stillKey &&
+            shownStill.vertices === model.vertices && shownStill.indices === model.indices) {
+            pending = null;
+            return true;
+        }
+        if (pending) stats.dropped++;
+        pending = { job, model };
+        pump();
+        return true;
+    }
+
+    // Blank the presentation layer once when frames stop (POINTS mode, pipeline toggled off)
+    function clear() {
+        if (!isInitialized || lastClearSeq === presentedSeq) return;
+        pending = null;
+        shownStill = null;
+        lastClearSeq = presentedSeq;
+        presentWorker.postMessage({ action: 'CLEAR', data: { seq: presentedSeq } });
+    }
+
+    /**
+     * Holds the pipeline and resolves once no frame is rendering or waiting to be presented,
+     * i.e. once the shared heap buffers are safe for the main thread to reuse. Frames submitted
+     * meanwhile only update the mailbox, so continuous submission cannot starve the caller.
+     * @returns {Promise<Function>} release() - call once done with the heap; the newest queued
+     *   frame then dispatches
+     */
+    function whenIdle() {
+        holds++;
+        let held = true;
+        const release = () => {
+            if (!held) return;
+            held = false;
+            holds--;
+            pump();
+        };
+        return new Promise(resolve => {
+            const poll = () => {
+                if (!isInitialized || (!geometryBusy && inFlight === 0 && Atomics.load(planeLocks, 0) === 0 && Atomics.load(planeLocks, 1) === 0)) resolve(release);
+                else setTimeout(poll, 4);
+            };
+            poll();
+        });
+    }
+
+    return {
+        init, submit, clear, whenIdle,
+        isReady: () => isInitialized,
+        getStats: () => stats
+    };
+})();
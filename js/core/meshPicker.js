@@ -0,0 +1,133 @@
+/**
+ * VEETANCE Mesh Picker
+ * Face / vertex / box queries on the resident mesh via the WASM BVH.
+ * Coordinates are canvas pixels (same space the rasterizer writes).
+ */
+window.ENGINE = window.ENGINE || {};
+window.ENGINE.MeshPicker = (function () {
+    const store = window.ENGINE.Store;
+    const SNAP_RADIUS = 10;
+
+    let builtVertices = null, builtIndices = null;
+    let builtVersion = -1;   // Heap residency version the BVH was last validated against
+    let pending = null;      // In-flight prepare()
+
+    // The BVH reads g_rawVertices/g_indices, so it is only valid while the heap still holds
+    // the sources it was built from (offline renders upload foreign meshes).
+    function isCurrent(WASM, state) {
+        if (builtIndices !== state.indices || builtVertices !== state.vertices) return false;
+        const resident = WASM.getResident();
+        if (resident.version === builtVersion) return true;
+        if (resident.vertices !== builtVertices || resident.indices !== builtIndices) return false;
+        builtVersion = resident.version; // Re-uploaded since: same data again
+        return true;
+    }
+
+    /**
+     * Makes the BVH match the current model: re-uploads if the heap was overwritten, refits
+     * when only vertex data changed, rebuilds otherwise. Runs eagerly on model changes so the
+     * SAH build never lands on a click. Object transforms need none of this.
+     * @returns {Promise<boolean>} false when there is no mesh or no BVH-capable core
+     */
+    function prepare() {
+        if (pending) return pending;
+        pending = (async () => {
+            const WASM = window.ENGINE.RasterizerWASM;
+            if (!WASM || !WASM.isReady() || !WASM.hasBVH()) return false;
+            // Uploads and the build write the shared heap: never while a pipeline worker reads it
+            const Pipeline = window.ENGINE.FramePipeline;
+            const release = Pipeline && Pipeline.isReady() ? await Pipeline.whenIdle() : null;
+            try {
+                return upload(WASM);
+            } finally {
+                if (release) release();
+            }
+        })().finally(() => { pending = null; });
+        return pending;
+    }
+
+    // Brings heap and BVH up to date; the pipeline is held by the caller
+    function upload(WASM) {
+        // An offline still owns the heap until it finishes; try again afterwards
+        const Offline = window.ENGINE.OfflineRenderer;
+        if (Offline && Offline.isActive()) {
+            setTimeout(prepare, 100);
+            return false;
+        }
+        const state = store.getState(); // Read after the wait: the model may have changed
+        const { vertices, indices } = state;
+        if (!vertices || !indices) return false;
+        if (isCurrent(WASM, state)) return true;
+
+        if (builtIndices === indices && builtVertices === vertices) {
+            WASM.ensureResident({ vertices, indices });
+        } else if (builtIndices === indices && builtVertices && builtVertices.length === vertices.length) {
+            WASM.ensureResident({ indices });
+            WASM.refitBVH(vertices);
+        } else {
+            const t0 = performance.now();
+            const nodes = WASM.buildBVH(vertices, indices);
+            if (window.ENGINE.Config.debug) console.log(`[DEUS] BVH: ${nodes} nodes over ${indices.length / 3} faces in ${(performance.now() - t0).toFixed(1)}ms`);
+        }
+        builtVertices = vertices;
+        builtIndices = indices;
+        builtVersion = WASM.getResident().version;
+        return true;
+    }
+
+    // Eager build: once per model change, after the dispatch that set it has finished
+    let seenVertices = null, seenIndices = null;
+    store.subscribe((state) => {
+        if (state.vertices === seenVertices && state.indices === seenIndices) return;
+        seenVertices = state.vertices;
+        seenIndices = state.indices;
+        setTimeout(prepare, 0);
+    });
+
+    /** Runs fn against an up-to-date BVH; null (and a background prepare) while it is not. */
+    function query(canvas, fn) {
+        const WASM = window.ENGINE.RasterizerWASM;
+        if (!WASM || !WASM.isReady() || !WASM.hasBVH()) return null;
+        const state = store.getState();
+        if (!isCurrent(WASM, state)) {
+            prepare();
+            return null;
+        }
+        const fovScale = (canvas.height / 2) / Math.tan((state.config.fov * 0.5) * Math.PI / 180);
+        return fn(WASM, window.ENGINE.Core.getViewModelMatrix(), fovScale);
+    }
+
+    /**
+     * Closest face under a canvas pixel.
+     * @returns {{face:number, t:number, u:number, v:number, point:number[]}|null}
+     */
+    function pickFace(px, py, canvas) {
+        return query(canvas, (WASM, m, fov) => WASM.raycast(m, px, py, canvas.width, canvas.height, fov));
+    }
+
+    /**
+     * Faces whose centroids project inside the rect, as coalesced face ranges.
+     * @returns {{ranges:Uint32Array, faceCount:number}|null}
+     */
+    function selectBox(x0, y0, x1, y1, canvas) {
+        return query(canvas, (WASM, m, fov) => WASM.selectBox(m, x0, y0, x1, y1, canvas.width, canvas.height, fov));
+    }
+
+    /**
+     * Nearest visible vertex within radius pixels.
+     * @returns {{vertex:number, point:number[]}|null}
+     */
+    function snapVertex(px, py, canvas, radius = SNAP_RADIUS) {
+        return query(canvas, (WASM, m, fov) => WASM.snapVertex(m, px, py, radius, canvas.width, canvas.height, fov));
+    }
+
+    // Force a rebuild (e.g. after topology edits that reuse the same index buffer)
+    function invalidate() {
+        builtVertices = null;
+        builtIndices = null;
+        builtVersion = -1;
+        setTimeout(prepare, 0);
+    }
+
+    return { pickFace, selectBox, snapVertex, invalidate, prepare };
+})();
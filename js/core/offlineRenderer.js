@@ -0,0 +1,133 @@
+/**
+ * VEETANCE Offline Renderer
+ * Stills of arbitrary size (8K, 16K...) from the resident mesh, rendered as a sequence of
+ * tile-aligned regions (identical to a single pass, no seams). Peak memory is one region
+ * whatever the output size; finished rows stream to a caller-supplied sink.
+ */
+window.ENGINE = window.ENGINE || {};
+window.ENGINE.OfflineRenderer = (function () {
+    const DEFAULT_LIGHT = (() => {
+        const l = [0.2, 0.3, 1.0], n = Math.hypot(l[0], l[1], l[2]);
+        return [l[0] / n, l[1] / n, l[2] / n]; // Same key light as the viewport
+    })();
+
+    let active = false;
+
+    /**
+     * Renders an opts.width x opts.height still.
+     * @param {Object} opts
+     *   width, height          - output size in pixels (unbounded)
+     *   matrix                 - model-view (default: last rendered view)
+     *   fov                    - vertical field of view in degrees (default: config.fov)
+     *   viewMode, polyColor, wireColor - default to the current config
+     *   vertices, indices, clusters    - mesh (default: the loaded model); headless callers pass these.
+     *                                    A caller's mesh without clusters renders unclustered
+     *   lightDir, onProgress(done, total)
+     * @param {(x:number, y:number, width:number, rgba:Uint8ClampedArray) => (void|Promise)} sink
+     *   Called once per finished row span. Regions run row-major, so spans of one image row
+     *   arrive in several calls. rgba is a transient heap view: copy it to keep it.
+     * @returns {Promise<{regions:number, faces:number, ms:number}>}
+     */
+    async function render(opts, sink) {
+        const WASM = window.ENGINE.RasterizerWASM;
+        const Config = window.ENGINE.Config;
+        if (!WASM || !WASM.isReady() || !WASM.hasOfflineRender()) throw new Error("Offline render needs the WASM core (renderRegion export).");
+        if (active) throw new Error("An offline render is already running.");
+
+        const store = window.ENGINE.Store;
+        const state = store ? store.getState() : null;
+        const config = state ? state.config : {};
+        // Clusters come from wherever the mesh comes from: the loaded model's clusters say nothing
+        // about a caller-supplied mesh
+        const ownMesh = !!(opts.vertices || opts.indices);
+        const vertices = ownMesh ? opts.vertices : state && state.vertices;
+        const indices = ownMesh ? opts.indices : state && state.indices;
+        const clusters = ownMesh ? opts.clusters : state && state.object && state.object.clusters;
+        const useClusters = !!(clusters && clusters.length > 0);
+        const Core = window.ENGINE.Core;
+        // Snapshot before the first await: a live matrix edited mid-still would tear regions at seams
+        const liveMatrix = opts.matrix || (Core && Core.getViewModelMatrix && Core.getViewModelMatrix());
+        const matrix = liveMatrix && Float32Array.from(liveMatrix);
+        if (!vertices || !indices || !matrix) throw new Error("Offline render needs a mesh and a view matrix.");
+
+        const width = Math.floor(opts.width), height = Math.floor(opts.height);
+        const fovDeg = opts.fov || config.fov || Config.DEFAULT_FOV;
+        const fovScale = (height / 2) / Math.tan((fovDeg * 0.5) * Math.PI / 180);
+        const viewMode = opts.viewMode || config.viewMode || 'SOLID';
+        const baseColor = WASM.packPolyColor(opts.polyColor || config.polyColor || Config.COLORS.poly);
+        const wireColor = WASM.packWireColor(opts.wireColor || config.fg || Config.COLORS.primary);
+        const lightDir = opts.lightDir || DEFAULT_LIGHT;
+
+        active = true;
+        let uploaded = false;
+        let release = null;
+        const t0 = performance.now();
+        try {
+            // Live frames share these heap buffers: let any in-flight pipelined frame finish
+            // first, and keep new ones from starting until the still is done
+            const Pipeline = window.ENGINE.FramePipeline;
+            if (Pipeline && Pipeline.isReady()) release = await Pipeline.whenIdle();
+
+            const vCount = vertices.length / 3, fCount = indices.length / 3;
+            uploaded = true;
+            WASM.uploadVertices(vertices);
+            WASM.uploadIndices(indices);
+            if (useClusters) WASM.uploadClusters(clusters);
+
+            const RW = Config.REGION_WIDTH, RH = Config.REGION_HEIGHT;
+            const cols = Math.ceil(width / RW), rows = Math.ceil(height / RH);
+            let faces = 0;
+            for (let ry = 0; ry < rows; ry++) {
+                for (let rx = 0; rx < cols; rx++) {
+                    const x = rx * RW, y = ry * RH;
+                    const w = Math.min(RW, width - x), h = Math.min(RH, height - y);
+                    const region = WASM.renderRegion(matrix, vCount, fCount, useClusters, width, height, x, y, w, h, fovScale, lightDir, viewMode, baseColor, wireColor);
+                    faces += region.faces;
+                    for (let row = 0; row < h; row++) {
+                        const pending = sink(x, y + row, w, region.rgba.subarray(row * w * 4, (row + 1) * w * 4));
+                        if (pending && pending.then) await pending; // Async sinks apply backpressure
+                    }
+                    if (opts.onProgress) opts.onProgress(ry * cols + rx + 1, rows * cols);
+                }
+            }
+            const ms = performance.now() - t0;
+            if (Config.debug) console.log(`[DEUS] Offline still ${width}x${height}: ${rows * cols} regions, ${faces} faces in ${ms.toFixed(0)}ms`);
+            return { regions: rows * cols, faces, ms };
+        } finally {
+            // Live frames and the picker assume the heap holds the loaded model: put it back if
+            // a headless caller's mesh replaced it (a no-op when the still used the live mesh)
+            const live = uploaded && store ? store.getState() : null;
+            if (live && live.vertices && live.indices) {
+                WASM.ensureResident({ vertices: live.vertices, indices: live.indices, clusters: live.object && live.object.clusters });
+            }
+            if (release) release();
+            active = false;
+        }
+    }
+
+    /**
+     * Binary PPM (P6) sink with bounded memory: spans are written in place at their file
+     * offset, so region order does not matter. writeAt(position, bytes) is e.g.
+     * FileSystemWritableFileStream.write({ type: 'write', position, data }) in the browser
+     * or fs.writeSync(fd, bytes, 0, bytes.length, position) in Node.
+     */
+    function createPPMSink(width, height, writeAt) {
+        const header = new TextEncoder().encode(`P6\n${width} ${height}\n255\n`);
+        let rgb = new Uint8Array(0);
+        let ready = writeAt(0, header);
+
+        return async (x, y, spanWidth, rgba) => {
+            if (ready) { await ready; ready = null; }
+            if (rgb.length !== spanWidth * 3) rgb = new Uint8Array(spanWidth * 3);
+            for (let i = 0, j = 0; i < spanWidth * 4; i += 4, j += 3) {
+                rgb[j] = rgba[i]; rgb[j + 1] = rgba[i + 1]; rgb[j + 2] = rgba[i + 2];
+            }
+            await writeAt(header.length + (y * width + x) * 3, rgb);
+        };
+    }
+
+    return {
+        render, createPPMSink,
+        isActive: () => active
+    };
+})();
@@ -63,8 +63,76 @@ window.ENGINE.Optimizer = {
         };
     },
 
+    /**
+     * Reorders faces IN PLACE along a Z-order (Morton) curve of their centroids, so that
+     * consecutive faces are spatial neighbours. Vertex indices are untouched.
+     * Run once at load time, before buildClusters and before the mesh is dispatched.
+     * @param {Float32Array} vertices
+     * @param {Uint32Array} indices
+     */
+    mortonSortFaces: (vertices, indices) => {
+        const fCount = indices.length / 3;
+        if (fCount < 2) return indices;
+
+        let minX = Infinity, minY = Infinity, minZ = Infinity;
+        let maxX = -Infinity, maxY = -Infinity, maxZ = -Infinity;
+        for (let i = 0; i < vertices.length; i += 3) {
+            const x = vertices[i], y = vertices[i + 1], z = vertices[i + 2];
+            if (x < minX) minX = x; if (x > maxX) maxX = x;
+            if (y < minY) minY = y; if (y > maxY) maxY = y;
+            if (z < minZ) minZ = z; if (z > maxZ) maxZ = z;
+        }
+        // 10 bits per axis over the mesh bounds (30-bit codes)
+        const sx = 1023 / ((maxX - minX) || 1), sy = 1023 / ((maxY - minY) || 1), sz = 1023 / ((maxZ - minZ) || 1);
+        const spread = (v) => {
+            v = (v | (v << 16)) & 0x030000FF;
+            v = (v | (v << 8)) & 0x0300F00F;
+            v = (v | (v << 4)) & 0x030C30C3;
+            return (v | (v << 2)) & 0x09249249;
+        };
+
+        let keys = new Uint32Array(fCount);
+        let order = new Uint32Array(fCount);
+        for (let f = 0; f < fCount; f++) {
+            const a = indices[f * 3] * 3, b = indices[f * 3 + 1] * 3, c = indices[f * 3 + 2] * 3;
+            const qx = Math.min(1023, Math.max(0, ((vertices[a] + vertices[b] + vertices[c]) / 3 - minX) * sx)) | 0;
+            const qy = Math.min(1023, Math.max(0, ((vertices[a + 1] + vertices[b + 1] + vertices[c + 1]) / 3 - minY) * sy)) | 0;
+            const qz = Math.min(1023, Math.max(0, ((vertices[a + 2] + vertices[b + 2] + vertices[c + 2]) / 3 - minZ) * sz)) | 0;
+            keys[f] = (spread(qx) | (spread(qy) << 1) | (spread(qz) << 2)) >>> 0;
+            order[f] = f;
+        }
+
+        // LSD radix sort on 3 x 10-bit digits (stable, O(n))
+        let tmpKeys = new Uint32Array(fCount), tmpOrder = new Uint32Array(fCount);
+        const counts = new Uint32Array(1024);
+        for (let shift = 0; shift < 30; shift += 10) {
+            counts.fill(0);
+            for (let i = 0; i < fCount; i++) counts[(keys[i] >>> shift) & 1023]++;
+            for (let d = 0, sum = 0; d < 1024; d++) { const c = counts[d]; counts[d] = sum; sum += c; }
+            for (let i = 0; i < fCount; i++) {
+                const dst = counts[(keys[i] >>> shift) & 1023]++;
+                tmpKeys[dst] = keys[i];
+                tmpOrder[dst] = order[i];
+            }
+            [keys, tmpKeys] = [tmpKeys, keys];
+            [order, tmpOrder] = [tmpOrder, order];
+        }
+
+        const src = indices.slice();
+        for (let i = 0; i < fCount; i++) {
+            const f = order[i] * 3;
+            indices[i * 3] = src[f];
+            indices[i * 3 + 1] = src[f + 1];
+            indices[i * 3 + 2] = src[f + 2];
+        }
+        return indices;
+    },
+
     /**
      * Fragments a mesh into localized packets for Cluster Culling.
+     * Chunks faces in their current order and never modifies the mesh. Clusters address faces by
+     * startFace, so tight spatial packets (what makes the per-cluster frustum/occlusion tests
+     * effective) need spatially ordered faces: loaders run mortonSortFaces first.
      * @param {Float32Array} vertices 
      * @param {Uint32Array} indices 
      * @param {number} trianglesPerCluster 
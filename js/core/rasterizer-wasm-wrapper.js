@@ -21,6 +21,7 @@ window.ENGINE.RasterizerWASM = (function () {
         auxDepths: 0,
         radixCounts: 0,
         matrix: 0,
+        queryMatrix: 0,
         rawVertices: 0
     };
 
@@ -36,12 +37,77 @@ window.ENGINE.RasterizerWASM = (function () {
         depths: null,
         auxIndices: null,
         matrix: null,
+        queryMatrix: null,
         rawVertices: null
     };
 
     let workers = [];
     let isInitialized = false;
 
+    // JS sources the shared heap currently holds. version bumps whenever one of them changes,
+    // so state derived from the heap (BVH, upload caches) can tell it was overwritten.
+    const resident = { vertices: null, indices: null, clusters: null, version: 0 };
+    function markResident(kind, source) {
+        if (resident[kind] === source) return;
+        resident[kind] = source;
+        resident.version++;
+    }
+
+    function uploadVertices(vertices) {
+        views.rawVertices.set(vertices);
+        markResident('vertices', vertices);
+    }
+
+    function uploadIndices(indices) {
+        views.indices.set(indices);
+        markResident('indices', indices);
+    }
+
+    function uploadClusters(clusters) {
+        const count = clusters.length;
+        const ptr = wasmModule._malloc(count * 48); // 12 floats (48 bytes) per cluster
+        const view = new Float32Array(wasmModule.HEAPU8.buffer, ptr, count * 12);
+        for (let i = 0; i < count; i++) {
+            const c = clusters[i];
+            const off = i * 12;
+            view.set(c.aabb, off);
+            view.set(c.sphere, off + 6);
+            const u32 = new Uint32Array(wasmModule.HEAPU8.buffer, ptr + (off + 10) * 4, 2);
+            u32[0] = c.startFace;
+            u32[1] = c.faceCount;
+        }
+        wasmModule._uploadClusters(ptr, count);
+        wasmModule._free(ptr);
+        markResident('clusters', clusters);
+    }
+
+    // Exports behind optional features, by feature. A binary built before these landed loads
+    // fine but quietly runs without them, so init() names what is missing (see
+    // WASM/build-wasm-accelerated.ps1, which verifies the same list after a build).
+    const FEATURE_EXPORTS = {
+        'occlusion culling': ['_processClustersOccluded', '_buildDepthPyramid', '_getOcclusionStats'],
+        'mesh picking': ['_buildBVH', '_refitBVH', '_bvhRaycast', '_bvhSelectBox', '_bvhSnapVertex', '_getPickResultBuffer', '_getSelectionRangesBuffer'],
+        'pipelined frames': ['_getOutFBPlane', 'stackRestore'],
+        'geometry/raster overlap': ['_getStageScreen', '_getStageDepths', '_getStageSortedIndices', '_getStageIntensities', '_getStageFaceColors'],
+        'dynamic resolution upscale': ['_upscaleColors'],
+        'region stills': ['_renderRegion']
+    };
+    let missingExports = [];
+
+    function checkExports() {
+        const disabled = [];
+        missingExports = [];
+        for (const [feature, names] of Object.entries(FEATURE_EXPORTS)) {
+            const missing = names.filter((name) => typeof wasmModule[name] !== 'function');
+            if (missing.length === 0) continue;
+            disabled.push(feature);
+            missingExports.push(...missing);
+        }
+        if (missingExports.length === 0) return;
+        console.error(`[DEUS] STALE WASM BINARY: rasterizer_v2.wasm lacks ${missingExports.join(', ')}. ` +
+            `Disabled: ${disabled.join(', ')}. Rebuild with WASM/build-wasm-accelerated.ps1 and commit rasterizer_v2.js/.wasm.`);
+    }
+
     const MAX_VERTICES = window.ENGINE.Config.MAX_VERTICES;
     const MAX_FACES = window.ENGINE.Config.MAX_FACES;
     const FB_SIZE = 2560 * 1600; // Match expanded kernel
@@ -64,6 +130,8 @@ window.ENGINE.RasterizerWASM = (function () {
 
                 if (window.Module && window.Module._renderBatch && hasMemory) {
                     wasmModule = window.Module;
+                    if (wasmModule._setDebug) wasmModule._setDebug(window.ENGINE.Config.debug ? 1 : 0);
+                    checkExports();
                     allocateBuffers();
                     await spawnWorkers();
                     isInitialized = true;
@@ -98,6 +166,8 @@ window.ENGINE.RasterizerWASM = (function () {
         ptrs.auxDepths = wasmModule._getAuxDepthsBuffer();
         ptrs.radixCounts = wasmModule._getRadixCountsBuffer();
         ptrs.matrix = wasmModule._getMatrixBuffer();
+        // Picking queries get their own matrix: g_matrix belongs to whichever frame is in flight
+        ptrs.queryMatrix = wasmModule._malloc(64);
         ptrs.tiles = wasmModule._getTilesBuffer();
         ptrs.outFB = wasmModule._getOutFBBuffer();
 
@@ -113,6 +183,7 @@ window.ENGINE.RasterizerWASM = (function () {
         views.auxIndices = new Uint32Array(buf, ptrs.auxIndices, MAX_FACES);
         views.auxDepths = new Float32Array(buf, ptrs.auxDepths, MAX_FACES);
         views.matrix = new Float32Array(buf, ptrs.matrix, 16);
+        views.queryMatrix = new Float32Array(buf, ptrs.queryMatrix, 16);
         views.rawVertices = new Float32Array(buf, ptrs.rawVertices, MAX_VERTICES * 3);
 
         if (window.ENGINE.Pool && window.ENGINE.Pool.manifestWasmBuffers) {
@@ -121,6 +192,19 @@ window.ENGINE.RasterizerWASM = (function () {
         console.log("[DEUS] Buffer addresses mapped:", ptrs);
     }
 
+    // Glue URL + binary for workers that instantiate the module on the shared heap
+    let workerPayload = null;
+    const loadWorkerPayload = async () => {
+        if (workerPayload) return workerPayload;
+        const version = '5'; // Cache bust - incremented for stride fix
+        const wasmJsUrl = `${location.origin}/js/core/wasm/rasterizer_v2.js?v=${version}`;
+        const binaryResp = await fetch(`${location.origin}/js/core/wasm/rasterizer_v2.wasm?v=${version}`);
+        if (!binaryResp.ok) throw new Error("WASM binary fetch failed");
+        const wasmBinary = await binaryResp.arrayBuffer();
+        workerPayload = { wasmJsUrl, wasmBinary, sharedMemory: wasmModule.wasmMemory };
+        return workerPayload;
+    };
+
     const spawnWorkers = async () => {
         if (typeof SharedArrayBuffer === 'undefined') {
             console.warn("VEETANCE: SharedArrayBuffer missing. Multi-core resonance disabled.");
@@ -128,12 +212,7 @@ window.ENGINE.RasterizerWASM = (function () {
             return;
         }
         const coreCount = navigator.hardwareConcurrency || 4;
-        const version = '5'; // Cache bust - incremented for stride fix
-        const wasmJsUrl = `${location.origin}/js/core/wasm/rasterizer_v2.js?v=${version}`;
-        const binaryResp = await fetch(`${location.origin}/js/core/wasm/rasterizer_v2.wasm?v=${version}`);
-        if (!binaryResp.ok) throw new Error("WASM binary fetch failed");
-        const wasmBinary = await binaryResp.arrayBuffer();
-        const sharedMemory = wasmModule.wasmMemory;
+        const { wasmJsUrl, wasmBinary, sharedMemory } = await loadWorkerPayload();
 
         console.log(`[DEUS] Spawning Legion of ${coreCount} workers...`);
 
@@ -161,17 +240,29 @@ window.ENGINE.RasterizerWASM = (function () {
         console.log(`[DEUS] Legion of ${workers.length} cores active. 🦾`);
     };
 
-    function render(ctx, validFaces, config, width, height, isUV) {
+    // '#RRGGBB' -> standard 0xFFRRGGBB for WASM extraction logic
+    function packPolyColor(hex) {
+        const baseColor = hex || '#474747';
+        const r = parseInt(baseColor.slice(1, 3), 16), g = parseInt(baseColor.slice(3, 5), 16), b = parseInt(baseColor.slice(5, 7), 16);
+        return 0xFF000000 | (r << 16) | (g << 8) | b;
+    }
+
+    // '#RRGGBB' -> 0xFFBBGGRR (ABGR heap order used by the WASM line rasterizer); packed numbers pass through
+    function packWireColor(color) {
+        if (typeof color !== 'string') return color;
+        return (0xFF000000 | (parseInt(color.slice(5, 7), 16) << 16) | (parseInt(color.slice(3, 5), 16) << 8) | parseInt(color.slice(1, 3), 16)) >>> 0;
+    }
+
+    function render(ctx, validFaces, config, width, height, isUV, offset = 0) {
         if (!isInitialized) return Promise.resolve();
+        const sortedPtr = ptrs.sortedIndices + offset * 4; // Occlusion phase 2 renders past phase 1
 
-        const baseColor = config.polyColor || '#474747';
-        const r = parseInt(baseColor.slice(1, 3), 16), g = parseInt(baseColor.slice(3, 5), 16), b = parseInt(baseColor.slice(5, 7), 16);
-        const wasmColor = 0xFF000000 | (r << 16) | (g << 8) | b;  // Standard 0xFFRRGGBB for WASM extraction logic
+        const wasmColor = packPolyColor(config.polyColor);
 
         // --- SEQUENTIAL TILED FALLBACK (The Scalar Path) ---
         if (true || workers.length === 0) {
             // Bin faces into tiles (Main Thread)
-            wasmModule._binFaces(ptrs.tiles, ptrs.screen, ptrs.indices, ptrs.sortedIndices, validFaces, width, height);
+            wasmModule._binFaces(ptrs.tiles, ptrs.screen, ptrs.indices, sortedPtr, validFaces, width, height);
 
             const tilesX = Math.ceil(width / TILE_SIZE);
             const tilesY = Math.ceil(height / TILE_SIZE);
@@ -192,7 +283,7 @@ window.ENGINE.RasterizerWASM = (function () {
 
         // 1. Bin faces into tiles (Main Thread)
         wasmModule._binFaces(
-            ptrs.tiles, ptrs.screen, ptrs.indices, ptrs.sortedIndices,
+            ptrs.tiles, ptrs.screen, ptrs.indices, sortedPtr,
             validFaces, width, height
         );
 
@@ -244,19 +335,39 @@ window.ENGINE.RasterizerWASM = (function () {
         wasmModule._renderWireframe(ptrs.pixels, ptrs.screen, ptrs.indices, ptrs.sortedIndices, validFaces, color, width, height, density);
     }
 
-    function flush(ctx, width, height) {
-        if (!offscreenCanvas || offscreenCanvas.width !== width || offscreenCanvas.height !== height) {
+    /**
+     * Presents the framebuffer at width x height. When the frame was rasterized at a reduced
+     * srcWidth x srcHeight (dynamic resolution), the SIMD bilinear upscale fills the
+     * presentation buffer; binaries without it fall back to a canvas-scaled drawImage.
+     */
+    function flush(ctx, width, height, srcWidth = width, srcHeight = height) {
+        const Config = window.ENGINE.Config;
+        const scaled = srcWidth !== width || srcHeight !== height;
+        const upscale = scaled && !!wasmModule._upscaleColors &&
+            width <= Config.PRESENT_MAX_WIDTH && height <= Config.PRESENT_MAX_HEIGHT;
+        const outW = scaled && !upscale ? srcWidth : width;
+        const outH = scaled && !upscale ? srcHeight : height;
+        if (!ptrs.outFB) ptrs.outFB = wasmModule._malloc(FB_SIZE * 4);
+
+        if (upscale) wasmModule._upscaleColors(ptrs.pixels, srcWidth, srcHeight, ptrs.outFB, width, height);
+        else wasmModule._extractColors(ptrs.pixels, ptrs.outFB, outW, outH);
+        present(ctx, outW, outH, width, height);
+    }
+
+    /**
+     * Draws the outW x outH presentation buffer (ptrs.outFB) to ctx, canvas-scaled when the
+     * target size differs. Used directly for stills assembled in place by renderStill().
+     */
+    function present(ctx, outW, outH, width = outW, height = outH) {
+        if (!offscreenCanvas || offscreenCanvas.width !== outW || offscreenCanvas.height !== outH) {
             offscreenCanvas = document.createElement('canvas');
-            offscreenCanvas.width = width;
-            offscreenCanvas.height = height;
+            offscreenCanvas.width = outW;
+            offscreenCanvas.height = outH;
             offscreenCtx = offscreenCanvas.getContext('2d');
-            offscreenImgData = offscreenCtx.createImageData(width, height);
+            offscreenImgData = offscreenCtx.createImageData(outW, outH);
             offscreenU32 = new Uint32Array(offscreenImgData.data.buffer);
         }
-        if (!ptrs.outFB) ptrs.outFB = wasmModule._malloc(FB_SIZE * 4);
-
-        wasmModule._extractColors(ptrs.pixels, ptrs.outFB, width, height);
-        const extractView = new Uint32Array(wasmModule.HEAPU8.buffer, ptrs.outFB, width * height);
+        const extractView = new Uint32Array(wasmModule.HEAPU8.buffer, ptrs.outFB, outW * outH);
 
         if (window.ENGINE.Config.debug && Math.random() < 0.01) {
             let nonZero = 0;
@@ -266,22 +377,32 @@ window.ENGINE.RasterizerWASM = (function () {
 
         offscreenU32.set(extractView);
         offscreenCtx.putImageData(offscreenImgData, 0, 0);
-        ctx.drawImage(offscreenCanvas, 0, 0);
+        if (outW !== width || outH !== height) ctx.drawImage(offscreenCanvas, 0, 0, width, height);
+        else ctx.drawImage(offscreenCanvas, 0, 0);
+    }
+
+    // Re-draws the last presented image (JS-side copy, unaffected by later heap writes)
+    function redraw(ctx, width, height) {
+        if (offscreenCanvas) ctx.drawImage(offscreenCanvas, 0, 0, width, height);
     }
 
     let offscreenCanvas = null, offscreenCtx = null, offscreenImgData = null, offscreenU32 = null;
 
     return {
-        init, render, renderWire, clearHW, flush,
+        init, render, renderWire, clearHW, flush, present, redraw, packPolyColor, packWireColor,
         processVertices: (vertices, matrix, count) => {
             views.matrix.set(matrix);
             if (vertices instanceof Float32Array) {
-                views.rawVertices.set(vertices);
+                uploadVertices(vertices);
                 wasmModule._transformBuffer(ptrs.world, ptrs.rawVertices, ptrs.matrix, count);
             } else {
                 wasmModule._transformBuffer(ptrs.world, vertices, ptrs.matrix, count);
             }
         },
+        /** Runs the shared frame sequence (frame-core.js) on the resident mesh; returns faces drawn. */
+        renderFrame: (job) => window.ENGINE.FrameCore.renderFrame(wasmModule, ptrs, job),
+        /** Full-resolution still beyond the framebuffer, assembled in the presentation buffer (see present()). */
+        renderStill: (job) => window.ENGINE.FrameCore.renderRegions(wasmModule, ptrs, job, ptrs.outFB),
         project: (count, width, height, fov) => wasmModule._projectBuffer(ptrs.screen, ptrs.world, count, width, height, fov),
         getWorkerCount: () => workers.length,
         processFaces: (fIdx, lightDir, isWire, width, height, viewMode) => {
@@ -289,29 +410,14 @@ window.ENGINE.RasterizerWASM = (function () {
             const isNormal = viewMode === 'NORMALS';
             return wasmModule._processFacesSIMD(ptrs.screen, ptrs.world, ptrs.indices, ptrs.depths, ptrs.sortedIndices, ptrs.intensities, ptrs.faceColors, fIdx, lightDir[0], lightDir[1], lightDir[2], isWire, isUV, isNormal, width, height);
         },
-        sortFaces: (fCount) => {
-            wasmModule._radixSort(ptrs.sortedIndices, ptrs.depths, fCount, ptrs.auxIndices, ptrs.auxDepths, ptrs.radixCounts);
-            return views.sortedIndices.subarray(0, fCount);
+        sortFaces: (fCount, offset = 0) => {
+            wasmModule._radixSort(ptrs.sortedIndices + offset * 4, ptrs.depths + offset * 4, fCount, ptrs.auxIndices, ptrs.auxDepths, ptrs.radixCounts);
+            return views.sortedIndices.subarray(offset, offset + fCount);
         },
         getViews: () => views,
-        uploadIndices: (indices) => views.indices.set(indices),
+        uploadIndices,
         getIndicesView: () => views.indices,
-        uploadClusters: (clusters) => {
-            const count = clusters.length;
-            const ptr = wasmModule._malloc(count * 48); // 12 floats (48 bytes) per cluster
-            const view = new Float32Array(wasmModule.HEAPU8.buffer, ptr, count * 12);
-            for (let i = 0; i < count; i++) {
-                const c = clusters[i];
-                const off = i * 12;
-                view.set(c.aabb, off);
-                view.set(c.sphere, off + 6);
-                const u32 = new Uint32Array(wasmModule.HEAPU8.buffer, ptr + (off + 10) * 4, 2);
-                u32[0] = c.startFace;
-                u32[1] = c.faceCount;
-            }
-            wasmModule._uploadClusters(ptr, count);
-            wasmModule._free(ptr);
-        },
+        uploadClusters,
         processClusters: (matrix, fIdx, lightDir, isWire, isUV, width, height) => {
             views.matrix.set(matrix);
             return wasmModule._processClusters(
@@ -319,6 +425,125 @@ window.ENGINE.RasterizerWASM = (function () {
                 ptrs.matrix, lightDir[0], lightDir[1], lightDir[2], isWire, isUV, width, height
             );
         },
+        // --- TWO-PHASE OCCLUSION CULLING ---
+        /** Feature exports this binary lacks (empty when it matches rasterizer.cpp). */
+        getMissingExports: () => missingExports,
+        hasOcclusionCulling: () => !!(wasmModule && wasmModule._processClustersOccluded),
+        processClustersOccluded: (phase, matrix, lightDir, isWire, viewMode, width, height, fov, offset = 0) => {
+            const isUV = viewMode === 'UV';
+            const isNormal = viewMode === 'NORMALS';
+            views.matrix.set(matrix);
+            return wasmModule._processClustersOccluded(
+                ptrs.screen, ptrs.world, ptrs.indices, ptrs.depths + offset * 4, ptrs.sortedIndices + offset * 4,
+                ptrs.intensities, ptrs.faceColors, ptrs.matrix, lightDir[0], lightDir[1], lightDir[2],
+                isWire, isUV, isNormal, width, height, fov, phase
+            );
+        },
+        buildDepthPyramid: (width, height) => wasmModule._buildDepthPyramid(ptrs.pixels, width, height),
+        getOcclusionStats: () => {
+            if (!isInitialized || !wasmModule._getOcclusionStats) return null;
+            const s = new Uint32Array(wasmModule.HEAPU8.buffer, wasmModule._getOcclusionStats(), 6);
+            return { clusters: s[0], phase1: s[1], phase2: s[2], occluded: s[3], frustum: s[4], culledFaces: s[5] };
+        },
+        // --- BVH SPATIAL QUERIES (model space; matrix = model-view used for rendering) ---
+        hasBVH: () => !!(wasmModule && wasmModule._buildBVH),
+        hasUpscale: () => !!(wasmModule && wasmModule._upscaleColors),
+        hasOfflineRender: () => !!(wasmModule && wasmModule._renderRegion),
+        /**
+         * Renders region (x, y, w, h) of an outW x outH still from the resident mesh.
+         * useClusters: the resident clusters were uploaded for this same mesh.
+         * Returns { faces, rgba } where rgba is a transient w*h*4 view into the heap.
+         */
+        renderRegion: (matrix, vCount, fCount, useClusters, outW, outH, x, y, w, h, fov, lightDir, viewMode, baseColor, wireColor) => {
+            views.matrix.set(matrix);
+            const faces = wasmModule._renderRegion(
+                ptrs.matrix, vCount, fCount, useClusters, outW, outH, x, y, w, h, fov,
+                lightDir[0], lightDir[1], lightDir[2], viewMode === 'WIRE', viewMode === 'UV', viewMode === 'NORMALS',
+                viewMode === 'SHADED_WIRE', baseColor, wireColor, ptrs.outFB, w
+            );
+            return { faces, rgba: new Uint8ClampedArray(wasmModule.HEAPU8.buffer, ptrs.outFB, w * h * 4) };
+        },
+        buildBVH: (vertices, indices) => {
+            uploadVertices(vertices);
+            uploadIndices(indices);
+            return wasmModule._buildBVH(indices.length / 3);
+        },
+        refitBVH: (vertices) => {
+            uploadVertices(vertices);
+            wasmModule._refitBVH();
+        },
+        raycast: (matrix, px, py, width, height, fov) => {
+            views.queryMatrix.set(matrix);
+            const face = wasmModule._bvhRaycast(ptrs.queryMatrix, px, py, width, height, fov);
+            if (face < 0) return null;
+            const res = new Float32Array(wasmModule.HEAPU8.buffer, wasmModule._getPickResultBuffer(), 8);
+            return { face, t: res[2], u: res[3], v: res[4], point: [res[5], res[6], res[7]] };
+        },
+        selectBox: (matrix, x0, y0, x1, y1, width, height, fov) => {
+            views.queryMatrix.set(matrix);
+            const rangeCount = wasmModule._bvhSelectBox(ptrs.queryMatrix, x0, y0, x1, y1, width, height, fov);
+            const faceCount = new Int32Array(wasmModule.HEAPU8.buffer, wasmModule._getPickResultBuffer(), 1)[0];
+            const ranges = new Uint32Array(wasmModule.HEAPU8.buffer, wasmModule._getSelectionRangesBuffer(), rangeCount * 2).slice();
+            return { ranges, faceCount }; // ranges = [start0, count0, start1, count1, ...]
+        },
+        snapVertex: (matrix, px, py, radius, width, height, fov) => {
+            views.queryMatrix.set(matrix);
+            const vertex = wasmModule._bvhSnapVertex(ptrs.queryMatrix, px, py, radius, width, height, fov);
+            if (vertex < 0) return null;
+            const res = new Float32Array(wasmModule.HEAPU8.buffer, wasmModule._getPickResultBuffer(), 8);
+            return { vertex, point: [res[5], res[6], res[7]] };
+        },
+        // --- PIPELINED FRAMES (see framePipeline.js) ---
+        /**
+         * Everything a worker needs to run frames on the shared heap, or null when the
+         * build lacks the double-buffered planes or a per-instance stack (stackRestore).
+         */
+        getPipelineContext: async () => {
+            if (!isInitialized || typeof SharedArrayBuffer === 'undefined') return null;
+            if (!wasmModule._getOutFBPlane || !wasmModule.stackRestore || !wasmModule.wasmMemory) return null;
+            const payload = await loadWorkerPayload();
+            const stages = wasmModule._getStageScreen ? [0, 1].map((set) => ({
+                screen: wasmModule._getStageScreen(set),
+                depths: wasmModule._getStageDepths(set),
+                sortedIndices: wasmModule._getStageSortedIndices(set),
+                intensities: wasmModule._getStageIntensities(set),
+                faceColors: wasmModule._getStageFaceColors(set)
+            })) : null; // Older builds: no geometry/raster split
+            return {
+                ...payload,
+                ptrs: { ...ptrs, stages },
+                planes: [wasmModule._getOutFBPlane(0), wasmModule._getOutFBPlane(1)]
+            };
+        },
+        uploadVertices,
+        // --- HEAP RESIDENCY ---
+        getResident: () => resident,
+        /**
+         * Uploads whatever part of {vertices, indices, clusters} the heap does not hold yet.
+         * Only call while no frame worker is using the heap. Returns true if anything moved.
+         */
+        ensureResident: (model) => {
+            const before = resident.version;
+            if (model.vertices && model.vertices !== resident.vertices) uploadVertices(model.vertices);
+            if (model.indices && model.indices !== resident.indices) uploadIndices(model.indices);
+            if (model.clusters && model.clusters.length > 0 && model.clusters !== resident.clusters) {
+                uploadClusters(model.clusters);
+            }
+            return resident.version !== before;
+        },
+        /**
+         * Per-frame upload rule, shared by the sync and pipelined paths: vertices every frame
+         * (in-place edits keep the array's identity), indices and clusters only when they are
+         * not resident. Pipelined: only call while no geometry stage runs; index or cluster
+         * changes additionally need the raster stage idle.
+         */
+        uploadFrameModel: (model) => {
+            uploadVertices(model.vertices);
+            if (model.indices !== resident.indices) uploadIndices(model.indices);
+            if (model.clusters && model.clusters.length > 0 && model.clusters !== resident.clusters) {
+                uploadClusters(model.clusters);
+            }
+        },
         isReady: () => isInitialized,
         malloc: (size) => wasmModule._malloc(size)
     };
@@ -0,0 +1,119 @@
+/**
+ * VEETANCE Resolution Scaler
+ * Frame-time budget controller for the WASM raster path.
+ * While the view is moving, the internal (tiled framebuffer) resolution follows the
+ * measured frame cost toward config.targetFrameMs; once it settles, full resolution returns.
+ * Stills larger than the framebuffer are rendered in regions rather than scaled down.
+ */
+window.ENGINE = window.ENGINE || {};
+window.ENGINE.ResolutionScaler = (function () {
+    const SETTLE_MS = 150;      // View must be still this long before a full-res frame
+    const EMA_ALPHA = 0.25;     // Cost smoothing
+    const MAX_STEP_DOWN = 0.8;  // Per-sample scale change limits (avoid oscillation)
+    const MAX_STEP_UP = 1.05;
+    const DEADBAND = 0.1;       // Ignore cost within ±10% of target
+    const MIN_DIM = 64;
+
+    let motionScale = 1;        // Scale carried between interaction bursts
+    let current = 1;
+    let smoothedMs = 0;
+    let lastMatrix = null;
+    let lastMotionTime = -Infinity;
+    let capped = null;          // Why the last frame is below maxRenderScale: 'framebuffer' | 'plane' | null
+    const warned = {};
+
+    /** Largest scale the fixed FB_WIDTH x FB_HEIGHT tile grid holds for this canvas in one pass. */
+    function fbCapacity(width, height) {
+        const C = window.ENGINE.Config;
+        return Math.min(1, C.FB_WIDTH / width, C.FB_HEIGHT / height);
+    }
+
+    /** Largest scale a presentation plane holds (bound for stills assembled from regions). */
+    function planeCapacity(width, height) {
+        const C = window.ENGINE.Config;
+        return Math.min(1, C.PRESENT_MAX_WIDTH / width, C.PRESENT_MAX_HEIGHT / height);
+    }
+
+    function warnCapped(reason, width, height, scale) {
+        capped = reason;
+        if (warned[reason]) return;
+        warned[reason] = true;
+        const C = window.ENGINE.Config;
+        const limit = reason === 'framebuffer' ? `${C.FB_WIDTH}x${C.FB_HEIGHT} framebuffer` : `${C.PRESENT_MAX_WIDTH}x${C.PRESENT_MAX_HEIGHT} presentation plane`;
+        console.warn(`[DEUS] ${width}x${height} canvas exceeds the ${limit}: rendering at ${Math.round(scale * 100)}% and upscaling.`);
+    }
+
+    function viewChanged(matrix) {
+        if (!lastMatrix) {
+            lastMatrix = Float32Array.from(matrix);
+            return true;
+        }
+        let changed = false;
+        for (let i = 0; i < 16; i++) {
+            if (Math.abs(matrix[i] - lastMatrix[i]) > 1e-6) { changed = true; break; }
+        }
+        if (changed) lastMatrix.set(matrix);
+        return changed;
+    }
+
+    /**
+     * Picks this frame's internal raster size.
+     * canRegions: the core can render a still in framebuffer-sized regions (renderRegion), so
+     * stills are only bounded by the presentation plane. Interaction frames always fit one pass.
+     * @returns {{scale:number, width:number, height:number, moving:boolean, regions:boolean}}
+     *   regions: render this frame with renderRegions() instead of a single tiled pass
+     */
+    function resolve(matrix, width, height, config, canRegions = false) {
+        const maxScale = config.maxRenderScale || 1;
+        const fbScale = fbCapacity(width, height);
+        const now = performance.now();
+        if (viewChanged(matrix)) lastMotionTime = now;
+        const moving = now - lastMotionTime < SETTLE_MS;
+        capped = null;
+
+        let regions = false;
+        if (config.dynamicResolution && moving) {
+            const cap = Math.min(maxScale, fbScale);
+            const minScale = Math.min(config.minRenderScale || 0.5, cap);
+            current = Math.max(minScale, Math.min(cap, motionScale));
+            if (fbScale < maxScale && current === cap) warnCapped('framebuffer', width, height, cap);
+        } else {
+            // Stills (and the non-adaptive mode) get full quality, in regions when one pass can't hold it
+            const stillCap = canRegions ? planeCapacity(width, height) : fbScale;
+            current = Math.min(maxScale, stillCap);
+            regions = canRegions && current > fbScale;
+            if (stillCap < maxScale) warnCapped(canRegions ? 'plane' : 'framebuffer', width, height, current);
+        }
+
+        const rw = Math.max(MIN_DIM, Math.min(width, Math.round(width * current)));
+        const rh = Math.max(MIN_DIM, Math.min(height, Math.round(height * current)));
+        return { scale: rh / height, width: rw, height: rh, moving, regions };
+    }
+
+    /**
+     * Feeds one measured frame cost (ms) taken at the current scale.
+     * Raster cost tracks pixel count (scale²), so the correction is sqrt(target / cost).
+     */
+    function report(ms, config) {
+        if (!(ms > 0) || !config.dynamicResolution) return;
+        // Only interaction frames steer the controller; stills are full-res by design
+        if (performance.now() - lastMotionTime >= SETTLE_MS) return;
+        smoothedMs = smoothedMs ? smoothedMs + (ms - smoothedMs) * EMA_ALPHA : ms;
+
+        const target = config.targetFrameMs || 16.7;
+        const ratio = target / smoothedMs;
+        if (ratio > 1 - DEADBAND && ratio < 1 + DEADBAND) return;
+
+        const step = Math.max(MAX_STEP_DOWN, Math.min(MAX_STEP_UP, Math.sqrt(ratio)));
+        motionScale = Math.max(config.minRenderScale || 0.5, Math.min(config.maxRenderScale || 1, current * step));
+        // Re-base the average to the predicted cost at the new scale so it doesn't overshoot
+        smoothedMs *= (motionScale / current) * (motionScale / current);
+    }
+
+    return {
+        resolve, report,
+        getScale: () => current,
+        getCapped: () => capped,
+        getSmoothedMs: () => smoothedMs
+    };
+})();
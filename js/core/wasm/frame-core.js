@@ -0,0 +1,131 @@
+/**
+ * VEETANCE Frame Core
+ * The WASM frame sequence shared by the synchronous path (engine.js, via the wrapper) and the
+ * pipelined workers: transform → project → faces or two-phase occlusion → sort → bin →
+ * tiles → wire. The result is left in the tiled framebuffer; presenting it is up to the caller.
+ * Without occlusion the sequence splits into geometry() and raster(), which the pipeline runs
+ * on separate workers over the two stage sets (stagePtrs).
+ * Loaded as a classic script on the main thread and through importScripts() in the workers.
+ */
+(function (root) {
+    const TILE_SIZE = 128;
+    const REGION_WIDTH = 2560, REGION_HEIGHT = 1536; // Tile-aligned regions, match rasterizer.cpp
+    let f32 = null;
+
+    function sort(M, ptrs, count, offset) {
+        M._radixSort(ptrs.sortedIndices + offset * 4, ptrs.depths + offset * 4, count, ptrs.auxIndices, ptrs.auxDepths, ptrs.radixCounts);
+    }
+
+    function rasterize(M, ptrs, job, count, offset) {
+        const { width, height } = job;
+        M._binFaces(ptrs.tiles, ptrs.screen, ptrs.indices, ptrs.sortedIndices + offset * 4, count, width, height);
+        const totalTiles = Math.ceil(width / TILE_SIZE) * Math.ceil(height / TILE_SIZE);
+        for (let i = 0; i < totalTiles; i++) {
+            M._renderTile(ptrs.pixels, ptrs.tiles, i, ptrs.screen, ptrs.indices, ptrs.intensities, ptrs.faceColors, job.baseColor, width, height, job.isUV);
+        }
+    }
+
+    /**
+     * ptrs with the per-frame buffers (screen, depths, sortedIndices, intensities, faceColors)
+     * of stage set 0 or 1. ptrs.stages comes from RasterizerWASM.getPipelineContext().
+     */
+    function stagePtrs(ptrs, set) {
+        return Object.assign({}, ptrs, ptrs.stages[set]);
+    }
+
+    /**
+     * Geometry stage: transform → project → cull/shade → depth sort into ptrs' stage buffers.
+     * Reads the resident mesh and writes ptrs.matrix / ptrs.world; never touches the framebuffer.
+     * @returns {number} faces to raster
+     */
+    function geometry(M, ptrs, job) {
+        const { width, height, fov, lightDir, viewMode, isWire, vCount, fCount } = job;
+        if (!f32 || f32.buffer !== M.HEAPU8.buffer) f32 = new Float32Array(M.HEAPU8.buffer);
+        f32.set(job.matrix, ptrs.matrix >> 2);
+
+        M._transformBuffer(ptrs.world, ptrs.rawVertices, ptrs.matrix, vCount);
+        M._projectBuffer(ptrs.screen, ptrs.world, vCount, width, height, fov);
+        const validFaces = M._processFacesSIMD(ptrs.screen, ptrs.world, ptrs.indices, ptrs.depths, ptrs.sortedIndices, ptrs.intensities, ptrs.faceColors,
+            fCount, lightDir[0], lightDir[1], lightDir[2], isWire, viewMode === 'UV', viewMode === 'NORMALS', width, height);
+        if (validFaces > 0) sort(M, ptrs, validFaces, 0);
+        return validFaces;
+    }
+
+    /** Raster stage: clears the framebuffer and draws validFaces sorted faces from ptrs' stage buffers. */
+    function raster(M, ptrs, job, validFaces) {
+        M._clearBuffers(ptrs.pixels, job.width, job.height);
+        if (validFaces === 0) return;
+        if (!job.isWire) rasterize(M, ptrs, job, validFaces, 0);
+        if (job.isWire || job.viewMode === 'SHADED_WIRE') {
+            M._renderWireframe(ptrs.pixels, ptrs.screen, ptrs.indices, ptrs.sortedIndices, validFaces, job.wireColor, job.width, job.height, job.wireDensity);
+        }
+    }
+
+    /**
+     * Renders one frame from the resident geometry (g_rawVertices / g_indices / clusters).
+     * @param {Object} M - Emscripten module instance (main thread or a worker's own)
+     * @param {Object} ptrs - heap buffer addresses (see RasterizerWASM.allocateBuffers)
+     * @param {Object} job - matrix, width, height, fov, lightDir, viewMode, isWire, isUV,
+     *   baseColor, wireColor, wireDensity, useOcclusion, vCount, fCount
+     * @returns {number} faces drawn (0 = nothing to present)
+     */
+    function renderFrame(M, ptrs, job) {
+        if (!job.useOcclusion) {
+            const validFaces = geometry(M, ptrs, job);
+            raster(M, ptrs, job, validFaces);
+            return validFaces;
+        }
+
+        // TWO-PHASE OCCLUSION: last frame's visible clusters seed the depth pyramid, then only
+        // clusters whose projected AABB passes the pyramid test are drawn. Phase 2 culls against
+        // phase 1's raster, so this path cannot be split into pipeline stages.
+        const { width, height, fov, lightDir, viewMode, isWire, vCount } = job;
+        const isUVMode = viewMode === 'UV', isNormal = viewMode === 'NORMALS';
+        if (!f32 || f32.buffer !== M.HEAPU8.buffer) f32 = new Float32Array(M.HEAPU8.buffer);
+        f32.set(job.matrix, ptrs.matrix >> 2);
+
+        M._transformBuffer(ptrs.world, ptrs.rawVertices, ptrs.matrix, vCount);
+        M._projectBuffer(ptrs.screen, ptrs.world, vCount, width, height, fov);
+        M._clearBuffers(ptrs.pixels, width, height);
+
+        const phase1 = M._processClustersOccluded(ptrs.screen, ptrs.world, ptrs.indices, ptrs.depths, ptrs.sortedIndices,
+            ptrs.intensities, ptrs.faceColors, ptrs.matrix, lightDir[0], lightDir[1], lightDir[2], isWire, isUVMode, isNormal, width, height, fov, 0);
+        if (phase1 > 0) { sort(M, ptrs, phase1, 0); rasterize(M, ptrs, job, phase1, 0); }
+        M._buildDepthPyramid(ptrs.pixels, width, height);
+        const phase2 = M._processClustersOccluded(ptrs.screen, ptrs.world, ptrs.indices, ptrs.depths + phase1 * 4, ptrs.sortedIndices + phase1 * 4,
+            ptrs.intensities, ptrs.faceColors, ptrs.matrix, lightDir[0], lightDir[1], lightDir[2], isWire, isUVMode, isNormal, width, height, fov, 1);
+        if (phase2 > 0) { sort(M, ptrs, phase2, phase1); rasterize(M, ptrs, job, phase2, phase1); }
+        const validFaces = phase1 + phase2;
+        if (validFaces > 0 && viewMode === 'SHADED_WIRE') {
+            M._renderWireframe(ptrs.pixels, ptrs.screen, ptrs.indices, ptrs.sortedIndices, validFaces, job.wireColor, width, height, job.wireDensity);
+        }
+        return validFaces;
+    }
+
+    /**
+     * Full-resolution still larger than the tiled framebuffer: renders job.width x job.height as
+     * tile-aligned regions (renderRegion) assembled in place in out (a presentation plane, row
+     * stride job.width), seam-free. Same job fields as renderFrame, plus useClusters (the resident clusters
+     * belong to this mesh); occlusion and wire density do not apply.
+     * @returns {number} faces drawn over all regions
+     */
+    function renderRegions(M, ptrs, job, out) {
+        const { width, height, fov, lightDir, viewMode, vCount, fCount } = job;
+        if (!f32 || f32.buffer !== M.HEAPU8.buffer) f32 = new Float32Array(M.HEAPU8.buffer);
+        f32.set(job.matrix, ptrs.matrix >> 2);
+
+        let faces = 0;
+        for (let y = 0; y < height; y += REGION_HEIGHT) {
+            for (let x = 0; x < width; x += REGION_WIDTH) {
+                faces += M._renderRegion(ptrs.matrix, vCount, fCount, !!job.useClusters, width, height, x, y,
+                    Math.min(REGION_WIDTH, width - x), Math.min(REGION_HEIGHT, height - y), fov,
+                    lightDir[0], lightDir[1], lightDir[2], viewMode === 'WIRE', viewMode === 'UV', viewMode === 'NORMALS',
+                    viewMode === 'SHADED_WIRE', job.baseColor, job.wireColor, out + (y * width + x) * 4, width);
+            }
+        }
+        return faces;
+    }
+
+    root.ENGINE = root.ENGINE || {};
+    root.ENGINE.FrameCore = { renderFrame, renderRegions, geometry, raster, stagePtrs };
+})(typeof window !== 'undefined' ? window : self);
@@ -0,0 +1,94 @@
+/**
+ * VEETANCE Pipelined Frame Worker
+ * Raster stage: draws frame N from the stage set the geometry worker filled (while that
+ * worker already runs geometry for N+1), then hands it to the present worker through the
+ * free colour plane. Frames that cannot be split into stages (two-phase occlusion, region
+ * stills) run here end to end while the geometry worker is idle.
+ */
+
+let ptrs = null;
+let planes = null;
+let locks = null;       // Int32Array over a SharedArrayBuffer: 1 = plane held by the present worker
+let stageLocks = null;  // 1 = stage set filled by the geometry worker, not yet rasterized
+let presentPort = null;
+let frameIndex = 0;
+
+self.importScripts('./frame-core.js');
+
+self.onmessage = function (e) {
+    const { action, data } = e.data;
+
+    if (action === 'INIT') {
+        const { wasmJsUrl, wasmBinary, sharedMemory, stackTop } = data;
+        ptrs = data.ptrs;
+        planes = data.planes;
+        locks = new Int32Array(data.locks);
+        stageLocks = data.stageLocks ? new Int32Array(data.stageLocks) : null;
+        presentPort = data.presentPort;
+        // Stage sets arrive from the geometry worker over their own channel
+        if (data.geometryPort) data.geometryPort.onmessage = (msg) => rasterStage(msg.data);
+
+        self.Module = {
+            wasmBinary: wasmBinary,
+            wasmMemory: sharedMemory,
+            print: (txt) => console.log("[DEUS-FRAME] " + txt),
+            printErr: (txt) => console.error("[DEUS-FRAME] " + txt),
+            onRuntimeInitialized: () => {
+                // Private C stack: the main thread keeps running queries on its own instance
+                self.Module.stackRestore(stackTop);
+                self.postMessage({ action: 'READY' });
+            }
+        };
+        self.importScripts(wasmJsUrl);
+    } else if (action === 'FRAME') {
+        const t0 = performance.now();
+        const validFaces = renderFrame(data);
+        self.postMessage({ action: 'FRAME_DONE', ms: performance.now() - t0, validFaces, serial: true });
+    }
+};
+
+function rasterStage({ job, set, validFaces }) {
+    const t0 = performance.now();
+    self.ENGINE.FrameCore.raster(self.Module, self.ENGINE.FrameCore.stagePtrs(ptrs, set), job, validFaces);
+    // The framebuffer now holds the frame: the geometry worker may refill this set
+    Atomics.store(stageLocks, set, 0);
+    Atomics.notify(stageLocks, set);
+    present(job, validFaces);
+    self.postMessage({ action: 'FRAME_DONE', ms: performance.now() - t0, validFaces });
+}
+
+// Unsplit frame (same sequence as the synchronous path, frame-core.js) on stage set 0
+function renderFrame(job) {
+    const M = self.Module;
+    const { width, height } = job;
+
+    if (job.regions) {
+        const plane = frameIndex & 1;
+        // Still beyond the framebuffer: regions are assembled directly in the free plane
+        Atomics.wait(locks, plane, 1);
+        const faces = self.ENGINE.FrameCore.renderRegions(M, ptrs, job, planes[plane]);
+        Atomics.store(locks, plane, 1);
+        presentPort.postMessage({ plane, width, height, seq: job.seq });
+        frameIndex++;
+        return faces;
+    }
+
+    return present(job, self.ENGINE.FrameCore.renderFrame(M, ptrs, job));
+}
+
+// Hands the finished framebuffer to the presenter through the free colour plane
+function present(job, validFaces) {
+    const M = self.Module;
+    const { width, height } = job;
+    const plane = frameIndex & 1;
+    Atomics.wait(locks, plane, 1);
+    // Dynamic resolution: upscale the reduced raster into the plane at presentation size
+    const upscale = job.presentWidth && (job.presentWidth !== width || job.presentHeight !== height);
+    const outW = upscale ? job.presentWidth : width, outH = upscale ? job.presentHeight : height;
+    if (upscale) M._upscaleColors(ptrs.pixels, width, height, planes[plane], outW, outH);
+    else M._extractColors(ptrs.pixels, planes[plane], width, height);
+    Atomics.store(locks, plane, 1);
+    presentPort.postMessage({ plane, width: outW, height: outH, seq: job.seq });
+    frameIndex++;
+    return validFaces;
+}
@@ -0,0 +1,46 @@
+/**
+ * VEETANCE Pipelined Geometry Worker
+ * Runs the geometry stage (transform → project → cull → sort) of frame N+1 into one stage
+ * set while the frame worker rasterizes frame N from the other, then hands the set over.
+ */
+
+let ptrs = null;
+let stageLocks = null;  // Int32Array over a SharedArrayBuffer: 1 = stage set waiting for / in raster
+let rasterPort = null;
+let stageIndex = 0;
+
+self.importScripts('./frame-core.js');
+
+self.onmessage = function (e) {
+    const { action, data } = e.data;
+
+    if (action === 'INIT') {
+        const { wasmJsUrl, wasmBinary, sharedMemory, stackTop } = data;
+        ptrs = data.ptrs;
+        stageLocks = new Int32Array(data.stageLocks);
+        rasterPort = data.rasterPort;
+
+        self.Module = {
+            wasmBinary: wasmBinary,
+            wasmMemory: sharedMemory,
+            print: (txt) => console.log("[DEUS-GEOM] " + txt),
+            printErr: (txt) => console.error("[DEUS-GEOM] " + txt),
+            onRuntimeInitialized: () => {
+                // Private C stack, separate from the main thread's and the frame worker's
+                self.Module.stackRestore(stackTop);
+                self.postMessage({ action: 'READY' });
+            }
+        };
+        self.importScripts(wasmJsUrl);
+    } else if (action === 'GEOMETRY') {
+        const t0 = performance.now();
+        const set = stageIndex & 1;
+        // The raster stage may still be reading this set (frame N-1): wait for it to let go
+        Atomics.wait(stageLocks, set, 1);
+        const validFaces = self.ENGINE.FrameCore.geometry(self.Module, self.ENGINE.FrameCore.stagePtrs(ptrs, set), data);
+        Atomics.store(stageLocks, set, 1);
+        rasterPort.postMessage({ job: data, set, validFaces });
+        stageIndex++;
+        self.postMessage({ action: 'GEOMETRY_DONE', ms: performance.now() - t0 });
+    }
+};
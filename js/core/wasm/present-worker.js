@@ -0,0 +1,45 @@
+/**
+ * VEETANCE Present Worker
+ * Owns the OffscreenCanvas and presents finished colour planes from the shared heap,
+ * keeping putImageData off the main thread.
+ */
+
+let canvas = null, ctx = null, imgData = null, u32 = null;
+let memory = null, planes = null, locks = null;
+let clearSeq = -1;
+
+self.onmessage = function (e) {
+    const { action, data } = e.data;
+
+    if (action === 'INIT') {
+        canvas = data.canvas;
+        ctx = canvas.getContext('2d');
+        memory = data.sharedMemory;
+        planes = data.planes;
+        locks = new Int32Array(data.locks);
+        data.framePort.onmessage = (msg) => present(msg.data);
+        self.postMessage({ action: 'READY' });
+    } else if (action === 'CLEAR') {
+        // Frames already in flight from before the clear must not resurface
+        clearSeq = data.seq;
+        if (ctx) ctx.clearRect(0, 0, canvas.width, canvas.height);
+    }
+};
+
+function present({ plane, width, height, seq }) {
+    const t0 = performance.now();
+    if (canvas.width !== width || canvas.height !== height || !imgData) {
+        canvas.width = width;
+        canvas.height = height;
+        imgData = ctx.createImageData(width, height);
+        u32 = new Uint32Array(imgData.data.buffer);
+    }
+    // ImageData cannot alias shared memory: copy out, then release the plane immediately
+    u32.set(new Uint32Array(memory.buffer, planes[plane], width * height));
+    Atomics.store(locks, plane, 0);
+    Atomics.notify(locks, plane);
+
+    if (seq <= clearSeq) return;
+    ctx.putImageData(imgData, 0, 0);
+    self.postMessage({ action: 'PRESENTED', ms: performance.now() - t0 });
+}
@@ -1,8 +1,18 @@
-﻿#include <emscripten/emscripten.h>
+﻿#ifdef __EMSCRIPTEN__
+#include <emscripten/emscripten.h>
+#include <wasm_simd128.h>
+#else
+// Native build (offline stills, headless harness): wasm_* intrinsics via SIMDe
+#define EMSCRIPTEN_KEEPALIVE
+#define SIMDE_ENABLE_NATIVE_ALIASES
+#include <simde/wasm/simd128.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
 #include <stdint.h>
 #include <algorithm>
 #include <math.h>
-#include <wasm_simd128.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,6 +44,12 @@ struct Tile {
 #define MAX_FACES 1500000
 #define FB_WIDTH 2560
 #define FB_HEIGHT 1600
+// Offline regions: the largest tile-aligned rect of the framebuffer. Regions on the global
+// TILE_SIZE grid rasterize every span from the same tile origin as a single pass (seam-exact).
+#define REGION_WIDTH (FB_WIDTH / TILE_SIZE * TILE_SIZE)
+#define REGION_HEIGHT (FB_HEIGHT / TILE_SIZE * TILE_SIZE)
+#define PRESENT_MAX_WIDTH 3840  // Presentation planes hold up to 4K (render scale upsamples into them)
+#define PRESENT_MAX_HEIGHT 2160
 
 static Pixel g_pixels[FB_WIDTH * FB_HEIGHT];
 static float g_rawVertices[MAX_VERTICES * 3];
@@ -50,7 +66,14 @@ static float g_auxDepths[MAX_FACES];
 static uint32_t g_radixCounts[256];
 static float g_matrix[16];
 static Tile g_tiles[1024]; // Up to 32x32 tiles (4096x4096 max)
-static uint32_t g_outFB[FB_WIDTH * FB_HEIGHT];
+static uint32_t g_outFB[2][PRESENT_MAX_WIDTH * PRESENT_MAX_HEIGHT]; // Colour planes (double-buffered for pipelined presentation)
+// Second stage set for pipelined frames: the geometry stage of frame N+1 writes one set while the
+// raster stage of frame N reads the other. Set 0 is g_screen/g_depths/... above.
+static float g_screen1[MAX_VERTICES * 4];
+static float g_depths1[MAX_FACES];
+static uint32_t g_sortedIndices1[MAX_FACES];
+static float g_intensities1[MAX_FACES];
+static uint32_t g_faceColors1[MAX_FACES];
 
 // Buffer address getters (exported to JS)
 EMSCRIPTEN_KEEPALIVE
@@ -99,46 +122,102 @@ EMSCRIPTEN_KEEPALIVE
 float* getVertexIntensitiesBuffer() { return g_vertexIntensities; }
 
 EMSCRIPTEN_KEEPALIVE
-uint32_t* getOutFBBuffer() { return g_outFB; }
+uint32_t* getOutFBBuffer() { return g_outFB[0]; }
+
+EMSCRIPTEN_KEEPALIVE
+uint32_t* getOutFBPlane(int plane) { return g_outFB[plane & 1]; }
+
+EMSCRIPTEN_KEEPALIVE
+float* getStageScreen(int set) { return (set & 1) ? g_screen1 : g_screen; }
+
+EMSCRIPTEN_KEEPALIVE
+float* getStageDepths(int set) { return (set & 1) ? g_depths1 : g_depths; }
+
+EMSCRIPTEN_KEEPALIVE
+uint32_t* getStageSortedIndices(int set) { return (set & 1) ? g_sortedIndices1 : g_sortedIndices; }
+
+EMSCRIPTEN_KEEPALIVE
+float* getStageIntensities(int set) { return (set & 1) ? g_intensities1 : g_intensities; }
+
+EMSCRIPTEN_KEEPALIVE
+uint32_t* getStageFaceColors(int set) { return (set & 1) ? g_faceColors1 : g_faceColors; }
+
+// Diagnostic logging (JS mirrors Config.debug via setDebug). Off natively: offline regions and
+// harness runs would otherwise print once per region.
+#ifdef __EMSCRIPTEN__
+static int g_debug = 1;
+#else
+static int g_debug = 0;
+#endif
+
+EMSCRIPTEN_KEEPALIVE
+void setDebug(int enabled) { g_debug = enabled; }
 
 
 // Global Memory for Cluster Culling
 Cluster* g_clusters = nullptr;
 int g_clusterCount = 0;
+uint32_t g_clusterFaceTotal = 0;   // Faces covered by the clusters (drives the adaptive stride)
+uint8_t* g_clusterVisible = nullptr; // Last frame's visibility (two-phase occlusion)
+uint8_t* g_clusterDrawn = nullptr;   // Drawn during the current frame
 
 EMSCRIPTEN_KEEPALIVE
 void uploadClusters(Cluster* data, int count) {
     if (g_clusters) free(g_clusters);
+    if (g_clusterVisible) free(g_clusterVisible);
+    if (g_clusterDrawn) free(g_clusterDrawn);
     g_clusters = (Cluster*)malloc(count * sizeof(Cluster));
     memcpy(g_clusters, data, count * sizeof(Cluster));
+    // New manifold: everything counts as visible so the first frame seeds a complete pyramid
+    g_clusterVisible = (uint8_t*)malloc(count);
+    g_clusterDrawn = (uint8_t*)malloc(count);
+    memset(g_clusterVisible, 1, count);
+    memset(g_clusterDrawn, 0, count);
     g_clusterCount = count;
+    g_clusterFaceTotal = 0;
+    for (int c = 0; c < count; c++) g_clusterFaceTotal += g_clusters[c].faceCount;
 }
 
+// 16.16 span fixed point in 64 bits: offline stills use image-global coordinates, and 32-bit
+// 16.16 overflows at |x| >= 32768. Inputs are clamped to +-2^30 px (far off any image) so
+// vertices near the near plane cannot overflow the conversion either.
 const int f_shift = 16;
-const int f_one = 1 << f_shift;
+const int64_t f_one = (int64_t)1 << f_shift;
+const float FIXED_LIMIT = 1073741824.0f;
+
+inline int64_t toFixed(float v) {
+    return (int64_t)(std::max(-FIXED_LIMIT, std::min(FIXED_LIMIT, v)) * (float)f_one);
+}
 
 // --- OPTIMIZED MATH UTILS ---
 inline float fastInvSqrt(float number) {
-    long i;
+    int32_t i; // Fixed width: 'long' is 64-bit in native (LP64) builds
     float x2, y;
     const float threehalfs = 1.5F;
     x2 = number * 0.5F;
     y = number;
     std::copy(reinterpret_cast<const char*>(&y), reinterpret_cast<const char*>(&y) + sizeof(float), reinterpret_cast<char*>(&i));
     i = 0x5f3759df - (i >> 1);
-    std::copy(reinterpret_cast<const char*>(&i), reinterpret_cast<const char*>(&i) + sizeof(long), reinterpret_cast<char*>(&y));
+    std::copy(reinterpret_cast<const char*>(&i), reinterpret_cast<const char*>(&i) + sizeof(int32_t), reinterpret_cast<char*>(&y));
     y = y * (threehalfs - (x2 * y * y));
     return y;
 }
 
+// Adaptive face stride for HIGH-POLY performance (live frames only; offline stills use 1)
+inline int faceStride(uint32_t fCount) {
+    if (fCount > 200000) return 4;
+    if (fCount > 50000) return 2;
+    return 1;
+}
+
 // --- SCANLINE RASTERIZER (Unified Buffer) ---
 
-inline void drawSpan(Pixel* pixels, int y, int fx1, int fx2, int fz1, int fz2, float fi1, float fi2, uint32_t color, int width, int height) {
+inline void drawSpan(Pixel* pixels, int y, int64_t fx1, int64_t fx2, int64_t fz1, int64_t fz2, float fi1, float fi2, uint32_t color, int width, int height) {
     if (y < 0 || y >= height) return;
     if (fx1 > fx2) { std::swap(fx1, fx2); std::swap(fz1, fz2); std::swap(fi1, fi2); }
     
-    int xStart = (fx1 + f_one - 1) >> f_shift;
-    int xEnd = (fx2 + f_one - 1) >> f_shift;
+    int64_t xStart = (fx1 + f_one - 1) >> f_shift;
+    int64_t xEnd = (fx2 + f_one - 1) >> f_shift;
     
     if (xStart >= xEnd) return;
     if (xEnd > width) xEnd = width;
@@ -147,7 +226,7 @@ inline void drawSpan(Pixel* pixels, int y, int fx1, int fx2, int fz1, int fz2, f
 
     float zStart = (float)fz1 / f_one;
     float zEnd = (float)fz2 / f_one;
-    int dx = fx2 - fx1;
+    int64_t dx = fx2 - fx1;
     
     float weight = (dx > 0) ? (float)((xStart << f_shift) - fx1) / dx : 0;
     float dz = (dx > 0) ? (zEnd - zStart) * f_one / dx : 0;
@@ -159,7 +238,7 @@ inline void drawSpan(Pixel* pixels, int y, int fx1, int fx2, int fz1, int fz2, f
     uint8_t r_src = (color >> 16) & 0xFF, g_src = (color >> 8) & 0xFF, b_src = color & 0xFF;
 
     Pixel* p = &pixels[y * FB_WIDTH + xStart];
-    for (int x = xStart; x < xEnd; x++) {
+    for (int64_t x = xStart; x < xEnd; x++) {
         if (z > p->depth) {
             p->depth = z;
             uint8_t r = (uint8_t)(r_src * intens), g = (uint8_t)(g_src * intens), b = (uint8_t)(b_src * intens);
@@ -188,8 +267,8 @@ inline void drawTriangleInternal(Pixel* pixels, int width, int height, float x0,
         int startY = std::max(0, iy0), endY = std::min(height, iy1);
         for (int y = startY; y < endY; y++) {
             float dy = (float)y - y0;
-            drawSpan(pixels, y, (int)((x0 + dy * dx01) * f_one), (int)((x0 + dy * dx02) * f_one), 
-                               (int)((z0 + dy * dz01) * f_one), (int)((z0 + dy * dz02) * f_one), 
+            drawSpan(pixels, y, toFixed(x0 + dy * dx01), toFixed(x0 + dy * dx02), 
+                               toFixed(z0 + dy * dz01), toFixed(z0 + dy * dz02), 
                                (i0 + dy * di01), (i0 + dy * di02), color, width, height);
         }
     }
@@ -200,8 +279,8 @@ inline void drawTriangleInternal(Pixel* pixels, int width, int height, float x0,
         int startY = std::max(0, iy1), endY = std::min(height, iy2);
         for (int y = startY; y < endY; y++) {
             float dyBot = (float)y - y1, dyTop = (float)y - y0;
-            drawSpan(pixels, y, (int)((x1 + dyBot * dx12) * f_one), (int)((x0 + dyTop * dx02) * f_one), 
-                               (int)((z1 + dyBot * dz12) * f_one), (int)((z0 + dyTop * dz02) * f_one), 
+            drawSpan(pixels, y, toFixed(x1 + dyBot * dx12), toFixed(x0 + dyTop * dx02), 
+                               toFixed(z1 + dyBot * dz12), toFixed(z0 + dyTop * dz02), 
                                (i1 + dyBot * di12), (i0 + dyTop * di02), color, width, height);
         }
     }
@@ -230,9 +309,8 @@ void transformBuffer(float* out, float* inp, float* m, int count) {
     }
 }
 
-EMSCRIPTEN_KEEPALIVE
-void projectBuffer(float* out, float* inp, int count, float width, float height, float fov) {
-    float cx = width * 0.5f, cy = height * 0.5f;
+// Principal point (cx, cy) is explicit so offline regions can shift it off-centre
+inline void projectBufferAt(float* out, float* inp, int count, float cx, float cy, float fov) {
     for (int i = 0; i < count; i++) {
         int ox = i * 4;
         float z = inp[ox + 2];
@@ -252,6 +330,11 @@ void projectBuffer(float* out, float* inp, int count, float width, float height,
     }
 }
 
+EMSCRIPTEN_KEEPALIVE
+void projectBuffer(float* out, float* inp, int count, float width, float height, float fov) {
+    projectBufferAt(out, inp, count, width * 0.5f, height * 0.5f, fov);
+}
+
 // --- FACE PRE-PROCESSING ---
 
 EMSCRIPTEN_KEEPALIVE
@@ -265,9 +348,7 @@ int processFaces(
     float w = (float)width, h = (float)height;
     
     // Adaptive stride for HIGH-POLY performance (Production Mode)
-    int stride = 1;
-    if (fCount > 200000) stride = 4;
-    else if (fCount > 50000) stride = 2;
+    int stride = faceStride(fCount);
 
     for (int i = 0; i < fCount; i += stride) {
         int i3 = i * 3;
@@ -318,9 +399,7 @@ int processFacesSIMD(
     int validCount = 0;
     
     // Adaptive stride for HIGH-POLY performance (Production Mode)
-    int stride = 1;
-    if (fCount > 200000) stride = 4;
-    else if (fCount > 50000) stride = 2;
+    int stride = faceStride(fCount);
     
     // SIMD Vectors for Lighting
     v128_t vLX = wasm_f32x4_splat(lx);
@@ -430,6 +509,731 @@ int processClusters(
     return validCount;
 }
 
+// --- TWO-PHASE OCCLUSION CULLING (HI-Z) ---
+// Phase 1 draws the clusters that were visible last frame. A min/max depth pyramid is then
+// built from g_pixels, and phase 2 tests every cluster's projected AABB against it: survivors
+// that were not drawn in phase 1 are drawn, and the result becomes next frame's visible set.
+
+#define HIZ_BLOCK 8 // Level 0 texel = 8x8 framebuffer pixels
+#define HIZ_MAX_LEVELS 16
+#define HIZ_L0_W ((FB_WIDTH + HIZ_BLOCK - 1) / HIZ_BLOCK)
+#define HIZ_L0_H ((FB_HEIGHT + HIZ_BLOCK - 1) / HIZ_BLOCK)
+
+struct HiZTexel {
+    float minDepth; // Farthest surface in the block (depth = 1/w, larger = closer)
+    float maxDepth; // Nearest surface in the block
+};
+
+struct OcclusionStats {
+    uint32_t clusterCount;
+    uint32_t phase1Clusters;   // Drawn from last frame's visible set
+    uint32_t phase2Clusters;   // Disoccluded this frame, drawn after the pyramid test
+    uint32_t occludedClusters; // Rejected by the pyramid
+    uint32_t frustumClusters;  // Rejected outside the viewport / behind the camera
+    uint32_t culledFaces;      // Faces skipped by both tests
+};
+
+static HiZTexel g_hiz[HIZ_L0_W * HIZ_L0_H * 2]; // Mip chain packed level after level
+static int g_hizOffset[HIZ_MAX_LEVELS], g_hizW[HIZ_MAX_LEVELS], g_hizH[HIZ_MAX_LEVELS];
+static int g_hizLevels = 0;
+static OcclusionStats g_occlusionStats;
+
+EMSCRIPTEN_KEEPALIVE
+HiZTexel* getDepthPyramidBuffer() { return g_hiz; }
+
+EMSCRIPTEN_KEEPALIVE
+OcclusionStats* getOcclusionStats() { return &g_occlusionStats; }
+
+EMSCRIPTEN_KEEPALIVE
+void buildDepthPyramid(Pixel* pixels, int width, int height) {
+    int w = (width + HIZ_BLOCK - 1) / HIZ_BLOCK, h = (height + HIZ_BLOCK - 1) / HIZ_BLOCK;
+
+    // Level 0: reduce 8x8 pixel blocks. Uncovered pixels keep the clear depth (-2000),
+    // so any block with a hole can never occlude anything (conservative by construction).
+    for (int by = 0; by < h; by++) {
+        int y0 = by * HIZ_BLOCK, y1 = std::min(height, y0 + HIZ_BLOCK);
+        for (int bx = 0; bx < w; bx++) {
+            int x0 = bx * HIZ_BLOCK, x1 = std::min(width, x0 + HIZ_BLOCK);
+            float dMin = 3.4e38f, dMax = -3.4e38f;
+            for (int y = y0; y < y1; y++) {
+                const Pixel* p = &pixels[y * FB_WIDTH + x0];
+                for (int x = x0; x < x1; x++, p++) {
+                    dMin = std::min(dMin, p->depth);
+                    dMax = std::max(dMax, p->depth);
+                }
+            }
+            g_hiz[by * w + bx] = { dMin, dMax };
+        }
+    }
+    g_hizOffset[0] = 0; g_hizW[0] = w; g_hizH[0] = h;
+    g_hizLevels = 1;
+
+    // Coarser levels: 2x2 reduction until a single texel remains
+    while ((w > 1 || h > 1) && g_hizLevels < HIZ_MAX_LEVELS) {
+        int L = g_hizLevels;
+        const HiZTexel* src = &g_hiz[g_hizOffset[L - 1]];
+        int sw = w, sh = h;
+        w = (w + 1) >> 1; h = (h + 1) >> 1;
+        g_hizOffset[L] = g_hizOffset[L - 1] + sw * sh;
+        g_hizW[L] = w; g_hizH[L] = h;
+        HiZTexel* dst = &g_hiz[g_hizOffset[L]];
+        for (int y = 0; y < h; y++) {
+            int sy0 = y * 2, sy1 = std::min(sh - 1, sy0 + 1);
+            for (int x = 0; x < w; x++) {
+                int sx0 = x * 2, sx1 = std::min(sw - 1, sx0 + 1);
+                const HiZTexel& a = src[sy0 * sw + sx0]; const HiZTexel& b = src[sy0 * sw + sx1];
+                const HiZTexel& c = src[sy1 * sw + sx0]; const HiZTexel& d = src[sy1 * sw + sx1];
+                dst[y * w + x] = {
+                    std::min(std::min(a.minDepth, b.minDepth), std::min(c.minDepth, d.minDepth)),
+                    std::max(std::max(a.maxDepth, b.maxDepth), std::max(c.maxDepth, d.maxDepth))
+                };
+            }
+        }
+        g_hizLevels++;
+    }
+}
+
+enum ClusterTest { CLUSTER_VISIBLE = 0, CLUSTER_FRUSTUM = 1, CLUSTER_OCCLUDED = 2 };
+
+/**
+ * Projects the cluster AABB (model space) through m and tests the screen rect.
+ * Boxes straddling the near plane are always visible; with useHiZ the nearest corner
+ * is compared against the farthest depth of the <= 2x2 pyramid texels covering the rect.
+ */
+inline int testClusterAt(const Cluster& cl, const float* m, int width, int height, float fov, float cx, float cy, bool useHiZ) {
+    float minX = 3.4e38f, minY = 3.4e38f, maxX = -3.4e38f, maxY = -3.4e38f, nearest = -3.4e38f;
+    int behind = 0;
+    for (int k = 0; k < 8; k++) {
+        float x = cl.aabb[(k & 1) ? 3 : 0], y = cl.aabb[(k & 2) ? 4 : 1], z = cl.aabb[(k & 4) ? 5 : 2];
+        float vx = m[0] * x + m[4] * y + m[8] * z + m[12];
+        float vy = m[1] * x + m[5] * y + m[9] * z + m[13];
+        float vz = m[2] * x + m[6] * y + m[10] * z + m[14];
+        if (vz > -0.01f) { behind++; continue; } // Same near plane as projectBuffer
+        float invW = 1.0f / -vz;
+        float sx = vx * fov * invW + cx, sy = -vy * fov * invW + cy;
+        minX = std::min(minX, sx); maxX = std::max(maxX, sx);
+        minY = std::min(minY, sy); maxY = std::max(maxY, sy);
+        nearest = std::max(nearest, invW);
+    }
+    if (behind == 8) return CLUSTER_FRUSTUM;
+    if (behind > 0) return CLUSTER_VISIBLE;
+    if (maxX < 0 || maxY < 0 || minX >= width || minY >= height) return CLUSTER_FRUSTUM;
+    if (!useHiZ || g_hizLevels == 0) return CLUSTER_VISIBLE;
+
+    int tx0 = std::max(0, (int)minX) / HIZ_BLOCK, tx1 = std::min(width - 1, (int)maxX) / HIZ_BLOCK;
+    int ty0 = std::max(0, (int)minY) / HIZ_BLOCK, ty1 = std::min(height - 1, (int)maxY) / HIZ_BLOCK;
+    int L = 0;
+    while (L < g_hizLevels - 1 && ((tx1 >> L) - (tx0 >> L) > 1 || (ty1 >> L) - (ty0 >> L) > 1)) L++;
+
+    const HiZTexel* lvl = &g_hiz[g_hizOffset[L]];
+    int lw = g_hizW[L];
+    float occluder = 3.4e38f;
+    for (int ty = ty0 >> L; ty <= (ty1 >> L); ty++)
+        for (int tx = tx0 >> L; tx <= (tx1 >> L); tx++)
+            occluder = std::min(occluder, lvl[ty * lw + tx].minDepth);
+    return nearest < occluder ? CLUSTER_OCCLUDED : CLUSTER_VISIBLE;
+}
+
+inline int testCluster(const Cluster& cl, const float* m, int width, int height, float fov, bool useHiZ) {
+    return testClusterAt(cl, m, width, height, fov, width * 0.5f, height * 0.5f, useHiZ);
+}
+
+/**
+ * Emits faces [first, last) that survive near/backface culling, taking every stride-th face
+ * (same global selection as processFaces). With clipW > 0, faces whose screen bounds miss
+ * [clipX, clipX + clipW) x [clipY, clipY + clipH) are dropped as well (offline regions).
+ */
+inline int emitFaceRange(
+    uint32_t first, uint32_t last, int stride, float* screen, float* world, uint32_t* indices,
+    float* depths, uint32_t* sortedIndices, float* intensities, uint32_t* faceColors,
+    int validCount, float lx, float ly, float lz, bool isWire, bool isUV, bool isNormal,
+    int clipX, int clipY, int clipW, int clipH
+) {
+    for (uint32_t i = first + (stride - first % stride) % stride; i < last; i += stride) {
+        int i3 = i * 3;
+        int i0 = indices[i3], i1 = indices[i3 + 1], i2 = indices[i3 + 2];
+        int i04 = i0 << 2, i14 = i1 << 2, i24 = i2 << 2;
+
+        if (screen[i04 + 3] < 0 || screen[i14 + 3] < 0 || screen[i24 + 3] < 0) continue;
+
+        float x0 = screen[i04], y0 = screen[i04 + 1], x1 = screen[i14], y1 = screen[i14 + 1], x2 = screen[i24], y2 = screen[i24 + 1];
+        float area = (x1 - x0) * (y2 - y0) - (y1 - y0) * (x2 - x0);
+        if (!isWire) {
+            if (area >= 0.0f) continue;
+        }
+        if (clipW > 0) {
+            if (std::max({x0, x1, x2}) < clipX || std::max({y0, y1, y2}) < clipY) continue;
+            if (std::min({x0, x1, x2}) >= clipX + clipW || std::min({y0, y1, y2}) >= clipY + clipH) continue;
+        }
+
+        float ax = world[i14] - world[i04], ay = world[i14 + 1] - world[i04 + 1], az = world[i14 + 2] - world[i04 + 2];
+        float bx = world[i24] - world[i04], by = world[i24 + 1] - world[i04 + 1], bz = world[i24 + 2] - world[i04 + 2];
+        float nx = ay * bz - az * by, ny = az * bx - ax * bz, nz = ax * by - ay * bx;
+        float lenSq = nx * nx + ny * ny + nz * nz;
+        if (lenSq > 0) { float invLen = fastInvSqrt(lenSq); nx *= invLen; ny *= invLen; nz *= invLen; }
+
+        if (isNormal || isUV) {
+            uint8_t r = (uint8_t)((nx * 0.5f + 0.5f) * 255.9f);
+            uint8_t g = (uint8_t)((ny * 0.5f + 0.5f) * 255.9f);
+            uint8_t b = (uint8_t)((nz * 0.5f + 0.5f) * 255.9f);
+            faceColors[i] = 0xFF000000 | (b << 16) | (g << 8) | r;
+        }
+
+        intensities[i] = std::max(0.2f, (nx * lx + ny * ly + nz * lz) * 0.8f + 0.2f);
+        depths[validCount] = (world[i04 + 2] + world[i14 + 2] + world[i24 + 2]) * 0.333333f;
+        sortedIndices[validCount] = i;
+        validCount++;
+    }
+    return validCount;
+}
+
+inline int emitClusterFaces(
+    const Cluster& cl, float* screen, float* world, uint32_t* indices,
+    float* depths, uint32_t* sortedIndices, float* intensities, uint32_t* faceColors,
+    int validCount, float lx, float ly, float lz, bool isWire, bool isUV, bool isNormal
+) {
+    // Same stride as processFaces: skipped faces leave holes in the depth pyramid, which only
+    // makes it farther (more conservative), never wrongly occluding
+    return emitFaceRange(cl.startFace, cl.startFace + cl.faceCount, faceStride(g_clusterFaceTotal), screen, world, indices,
+                         depths, sortedIndices, intensities, faceColors, validCount, lx, ly, lz, isWire, isUV, isNormal, 0, 0, 0, 0);
+}
+
+/**
+ * Two-phase cluster processing. Call with phase 0, sort/bin/render the result, call
+ * buildDepthPyramid, then call with phase 1 and render its faces on top (same z-buffer).
+ * depths/sortedIndices may point past the phase 0 output so both phases stay contiguous.
+ */
+EMSCRIPTEN_KEEPALIVE
+int processClustersOccluded(
+    float* screen, float* world, uint32_t* indices,
+    float* depths, uint32_t* sortedIndices, float* intensities, uint32_t* faceColors,
+    float* m, float lx, float ly, float lz, bool isWire, bool isUV, bool isNormal,
+    int width, int height, float fov, int phase
+) {
+    OcclusionStats& st = g_occlusionStats;
+    int validCount = 0;
+
+    if (phase == 0) {
+        st = { (uint32_t)g_clusterCount, 0, 0, 0, 0, 0 };
+        g_hizLevels = 0;
+        for (int c = 0; c < g_clusterCount; c++) {
+            g_clusterDrawn[c] = 0;
+            if (!g_clusterVisible[c]) continue;
+            const Cluster& cl = g_clusters[c];
+            if (testCluster(cl, m, width, height, fov, false) != CLUSTER_VISIBLE) continue;
+            g_clusterDrawn[c] = 1;
+            st.phase1Clusters++;
+            validCount = emitClusterFaces(cl, screen, world, indices, depths, sortedIndices, intensities, faceColors,
+                                          validCount, lx, ly, lz, isWire, isUV, isNormal);
+        }
+        return validCount;
+    }
+
+    for (int c = 0; c < g_clusterCount; c++) {
+        const Cluster& cl = g_clusters[c];
+        int result = testCluster(cl, m, width, height, fov, true);
+        g_clusterVisible[c] = result == CLUSTER_VISIBLE;
+        if (g_clusterDrawn[c]) continue;
+
+        if (result == CLUSTER_VISIBLE) {
+            g_clusterDrawn[c] = 1;
+            st.phase2Clusters++;
+            validCount = emitClusterFaces(cl, screen, world, indices, depths, sortedIndices, intensities, faceColors,
+                                          validCount, lx, ly, lz, isWire, isUV, isNormal);
+        } else {
+            if (result == CLUSTER_OCCLUDED) st.occludedClusters++;
+            else st.frustumClusters++;
+            st.culledFaces += cl.faceCount;
+        }
+    }
+    return validCount;
+}
+
+// --- BVH SPATIAL QUERIES (PICKING / SELECTION / SNAPPING) ---
+// Built over g_rawVertices/g_indices in model space. Object transforms only change the query
+// matrix, so gizmo edits never touch the tree; refitBVH covers in-place vertex edits.
+
+#define BVH_LEAF_SIZE 4
+#define BVH_BINS 12
+#define BVH_MAX_DEPTH 60
+#define BVH_STACK 64
+
+struct BVHNode {
+    float bmin[3];
+    uint32_t leftFirst; // Inner: left child (right = left + 1). Leaf: first slot in g_bvhFaces
+    float bmax[3];
+    uint32_t count;     // 0 = inner node
+};
+
+struct PickResult {
+    int32_t face;       // -1 = miss
+    int32_t vertex;     // Snapped vertex, -1 = none
+    float t, u, v;      // Ray parameter (view-space distance along -Z) and barycentrics
+    float point[3];     // Model-space hit / snapped position
+};
+
+static BVHNode* g_bvhNodes = nullptr;
+static uint32_t* g_bvhFaces = nullptr;
+static uint32_t* g_bvhSelectMask = nullptr; // 1 bit per face for box selection
+static uint32_t* g_bvhRanges = nullptr;     // (startFace, faceCount) pairs
+static uint32_t g_bvhNodeCount = 0, g_bvhFaceCount = 0;
+static PickResult g_pickResult;
+
+EMSCRIPTEN_KEEPALIVE
+PickResult* getPickResultBuffer() { return &g_pickResult; }
+
+EMSCRIPTEN_KEEPALIVE
+uint32_t* getSelectionRangesBuffer() { return g_bvhRanges; }
+
+inline void bvhUpdateLeafBounds(BVHNode& n) {
+    float mn[3] = { 3.4e38f, 3.4e38f, 3.4e38f }, mx[3] = { -3.4e38f, -3.4e38f, -3.4e38f };
+    for (uint32_t i = n.leftFirst; i < n.leftFirst + n.count; i++) {
+        const uint32_t* tri = &g_indices[g_bvhFaces[i] * 3];
+        for (int k = 0; k < 3; k++) {
+            const float* v = &g_rawVertices[tri[k] * 3];
+            for (int a = 0; a < 3; a++) { mn[a] = std::min(mn[a], v[a]); mx[a] = std::max(mx[a], v[a]); }
+        }
+    }
+    for (int a = 0; a < 3; a++) { n.bmin[a] = mn[a]; n.bmax[a] = mx[a]; }
+}
+
+inline float bvhArea(const float* mn, const float* mx) {
+    float ex = mx[0] - mn[0], ey = mx[1] - mn[1], ez = mx[2] - mn[2];
+    return ex * ey + ey * ez + ez * ex;
+}
+
+/**
+ * Binned-SAH build. Nodes are appended in creation order, so a single forward sweep
+ * subdivides without recursion and children always sit after their parent (refit = reverse sweep).
+ * Node storage starts at fCount / 2 and grows by half as needed (4-face leaves rarely need
+ * more than ~0.7 nodes per face) instead of reserving the 2 * fCount worst case up front.
+ */
+EMSCRIPTEN_KEEPALIVE
+int buildBVH(int fCount) {
+    if (g_bvhNodes) free(g_bvhNodes);
+    if (g_bvhFaces) free(g_bvhFaces);
+    if (g_bvhSelectMask) free(g_bvhSelectMask);
+    if (g_bvhRanges) free(g_bvhRanges);
+    g_bvhNodes = nullptr; g_bvhFaces = nullptr; g_bvhSelectMask = nullptr; g_bvhRanges = nullptr;
+    g_bvhNodeCount = 0; g_bvhFaceCount = 0;
+    if (fCount <= 0) return 0;
+
+    uint32_t maxNodes = (uint32_t)fCount / 2 + 3;
+    g_bvhFaces = (uint32_t*)malloc(fCount * sizeof(uint32_t));
+    g_bvhNodes = (BVHNode*)malloc(maxNodes * sizeof(BVHNode));
+    float* centroids = (float*)malloc(fCount * 3 * sizeof(float));
+    uint8_t* depth = (uint8_t*)malloc(maxNodes);
+
+    for (int f = 0; f < fCount; f++) {
+        const uint32_t* tri = &g_indices[f * 3];
+        const float *a = &g_rawVertices[tri[0] * 3], *b = &g_rawVertices[tri[1] * 3], *c = &g_rawVertices[tri[2] * 3];
+        centroids[f * 3] = (a[0] + b[0] + c[0]) * 0.333333f;
+        centroids[f * 3 + 1] = (a[1] + b[1] + c[1]) * 0.333333f;
+        centroids[f * 3 + 2] = (a[2] + b[2] + c[2]) * 0.333333f;
+        g_bvhFaces[f] = f;
+    }
+
+    g_bvhNodes[0].leftFirst = 0;
+    g_bvhNodes[0].count = fCount;
+    bvhUpdateLeafBounds(g_bvhNodes[0]);
+    depth[0] = 0;
+    g_bvhNodeCount = 1;
+
+    for (uint32_t n = 0; n < g_bvhNodeCount; n++) {
+        BVHNode& node = g_bvhNodes[n];
+        if (node.count <= BVH_LEAF_SIZE || depth[n] >= BVH_MAX_DEPTH) continue;
+        uint32_t first = node.leftFirst, count = node.count;
+
+        float cmin[3] = { 3.4e38f, 3.4e38f, 3.4e38f }, cmax[3] = { -3.4e38f, -3.4e38f, -3.4e38f };
+        for (uint32_t i = first; i < first + count; i++) {
+            const float* c = &centroids[g_bvhFaces[i] * 3];
+            for (int a = 0; a < 3; a++) { cmin[a] = std::min(cmin[a], c[a]); cmax[a] = std::max(cmax[a], c[a]); }
+        }
+
+        // One pass bins every face on all three axes (vertex reads dominate the build)
+        float scale[3];
+        for (int a = 0; a < 3; a++) scale[a] = cmax[a] > cmin[a] ? BVH_BINS / (cmax[a] - cmin[a]) : 0.0f;
+        uint32_t binCount[3][BVH_BINS] = {};
+        float binMin[3][BVH_BINS][3], binMax[3][BVH_BINS][3];
+        for (int a = 0; a < 3; a++)
+            for (int b = 0; b < BVH_BINS; b++)
+                for (int k = 0; k < 3; k++) { binMin[a][b][k] = 3.4e38f; binMax[a][b][k] = -3.4e38f; }
+        for (uint32_t i = first; i < first + count; i++) {
+            uint32_t f = g_bvhFaces[i];
+            const uint32_t* tri = &g_indices[f * 3];
+            const float *p0 = &g_rawVertices[tri[0] * 3], *p1 = &g_rawVertices[tri[1] * 3], *p2 = &g_rawVertices[tri[2] * 3];
+            float fmn[3], fmx[3];
+            for (int k = 0; k < 3; k++) {
+                fmn[k] = std::min(p0[k], std::min(p1[k], p2[k]));
+                fmx[k] = std::max(p0[k], std::max(p1[k], p2[k]));
+            }
+            for (int a = 0; a < 3; a++) {
+                if (scale[a] == 0.0f) continue;
+                int b = std::min(BVH_BINS - 1, (int)((centroids[f * 3 + a] - cmin[a]) * scale[a]));
+                binCount[a][b]++;
+                for (int k = 0; k < 3; k++) { binMin[a][b][k] = std::min(binMin[a][b][k], fmn[k]); binMax[a][b][k] = std::max(binMax[a][b][k], fmx[k]); }
+            }
+        }
+
+        int bestAxis = -1, bestSplit = 0;
+        float bestCost = (float)count * bvhArea(node.bmin, node.bmax);
+        for (int a = 0; a < 3; a++) {
+            if (scale[a] == 0.0f) continue;
+            // Sweep: left areas/counts forward, right side backward
+            float leftArea[BVH_BINS - 1]; uint32_t leftCount[BVH_BINS - 1];
+            float mn[3] = { 3.4e38f, 3.4e38f, 3.4e38f }, mx[3] = { -3.4e38f, -3.4e38f, -3.4e38f };
+            uint32_t sum = 0;
+            for (int b = 0; b < BVH_BINS - 1; b++) {
+                sum += binCount[a][b];
+                for (int k = 0; k < 3; k++) { mn[k] = std::min(mn[k], binMin[a][b][k]); mx[k] = std::max(mx[k], binMax[a][b][k]); }
+                leftCount[b] = sum; leftArea[b] = sum ? bvhArea(mn, mx) : 0.0f;
+            }
+            for (int k = 0; k < 3; k++) { mn[k] = 3.4e38f; mx[k] = -3.4e38f; }
+            sum = 0;
+            for (int b = BVH_BINS - 1; b > 0; b--) {
+                sum += binCount[a][b];
+                for (int k = 0; k < 3; k++) { mn[k] = std::min(mn[k], binMin[a][b][k]); mx[k] = std::max(mx[k], binMax[a][b][k]); }
+                if (!sum || !leftCount[b - 1]) continue;
+                float cost = leftCount[b - 1] * leftArea[b - 1] + sum * bvhArea(mn, mx);
+                if (cost < bestCost) { bestCost = cost; bestAxis = a; bestSplit = b; }
+            }
+        }
+        if (bestAxis < 0) continue; // Leaf: splitting does not pay off (or coincident centroids)
+
+        int i = first, j = first + count - 1;
+        while (i <= j) {
+            int b = std::min(BVH_BINS - 1, (int)((centroids[g_bvhFaces[i] * 3 + bestAxis] - cmin[bestAxis]) * scale[bestAxis]));
+            if (b < bestSplit) i++;
+            else std::swap(g_bvhFaces[i], g_bvhFaces[j--]);
+        }
+        uint32_t leftCountFinal = i - first;
+        if (leftCountFinal == 0 || leftCountFinal == count) continue;
+
+        if (g_bvhNodeCount + 2 > maxNodes) {
+            // Grow (invalidates node; everything below re-fetches by index)
+            maxNodes = std::min(2 * (uint32_t)fCount, maxNodes + maxNodes / 2);
+            g_bvhNodes = (BVHNode*)realloc(g_bvhNodes, maxNodes * sizeof(BVHNode));
+            depth = (uint8_t*)realloc(depth, maxNodes);
+        }
+        uint32_t left = g_bvhNodeCount;
+        g_bvhNodeCount += 2;
+        BVHNode& l = g_bvhNodes[left];
+        BVHNode& r = g_bvhNodes[left + 1];
+        l.leftFirst = first; l.count = leftCountFinal;
+        r.leftFirst = i; r.count = count - leftCountFinal;
+        // Child bounds fall out of the winning axis' bins: no second pass over the vertices
+        for (int k = 0; k < 3; k++) {
+            l.bmin[k] = r.bmin[k] = 3.4e38f; l.bmax[k] = r.bmax[k] = -3.4e38f;
+        }
+        for (int b = 0; b < BVH_BINS; b++) {
+            BVHNode& c = b < bestSplit ? l : r;
+            for (int k = 0; k < 3; k++) {
+                c.bmin[k] = std::min(c.bmin[k], binMin[bestAxis][b][k]);
+                c.bmax[k] = std::max(c.bmax[k], binMax[bestAxis][b][k]);
+            }
+        }
+        depth[left] = depth[left + 1] = depth[n] + 1;
+        g_bvhNodes[n].leftFirst = left;
+        g_bvhNodes[n].count = 0;
+    }
+
+    free(centroids);
+    free(depth);
+    g_bvhNodes = (BVHNode*)realloc(g_bvhNodes, g_bvhNodeCount * sizeof(BVHNode));
+    g_bvhSelectMask = (uint32_t*)malloc(((fCount + 31) / 32) * sizeof(uint32_t));
+    g_bvhRanges = (uint32_t*)malloc((fCount + 1) * sizeof(uint32_t));
+    g_bvhFaceCount = fCount;
+    return g_bvhNodeCount;
+}
+
+/**
+ * Recomputes bounds bottom-up from the current g_rawVertices (same topology).
+ * Use after vertex edits; object transforms never need it.
+ */
+EMSCRIPTEN_KEEPALIVE
+void refitBVH() {
+    for (int n = (int)g_bvhNodeCount - 1; n >= 0; n--) {
+        BVHNode& node = g_bvhNodes[n];
+        if (node.count) { bvhUpdateLeafBounds(node); continue; }
+        const BVHNode& l = g_bvhNodes[node.leftFirst];
+        const BVHNode& r = g_bvhNodes[node.leftFirst + 1];
+        for (int a = 0; a < 3; a++) {
+            node.bmin[a] = std::min(l.bmin[a], r.bmin[a]);
+            node.bmax[a] = std::max(l.bmax[a], r.bmax[a]);
+        }
+    }
+}
+
+// Inverse of the affine model-view matrix (column-major, last row 0 0 0 1)
+inline bool invertAffine(const float* m, float* inv) {
+    float a00 = m[0], a01 = m[4], a02 = m[8], a10 = m[1], a11 = m[5], a12 = m[9], a20 = m[2], a21 = m[6], a22 = m[10];
+    float c00 = a11 * a22 - a12 * a21, c01 = a02 * a21 - a01 * a22, c02 = a01 * a12 - a02 * a11;
+    float det = a00 * c00 + a10 * c01 + a20 * c02;
+    if (fabsf(det) < 1e-20f) return false;
+    float id = 1.0f / det;
+    inv[0] = c00 * id; inv[4] = c01 * id; inv[8] = c02 * id;
+    inv[1] = (a12 * a20 - a10 * a22) * id; inv[5] = (a00 * a22 - a02 * a20) * id; inv[9] = (a02 * a10 - a00 * a12) * id;
+    inv[2] = (a10 * a21 - a11 * a20) * id; inv[6] = (a01 * a20 - a00 * a21) * id; inv[10] = (a00 * a11 - a01 * a10) * id;
+    inv[3] = inv[7] = inv[11] = 0.0f; inv[15] = 1.0f;
+    for (int r = 0; r < 3; r++) inv[12 + r] = -(inv[r] * m[12] + inv[4 + r] * m[13] + inv[8 + r] * m[14]);
+    return true;
+}
+
+inline float bvhRayBox(const BVHNode& n, const float* o, const float* invD, float tMax) {
+    float t0 = 0.0f, t1 = tMax;
+    for (int a = 0; a < 3; a++) {
+        float tn = (n.bmin[a] - o[a]) * invD[a], tf = (n.bmax[a] - o[a]) * invD[a];
+        if (tn > tf) std::swap(tn, tf);
+        t0 = std::max(t0, tn); t1 = std::min(t1, tf);
+        if (t0 > t1) return 3.4e38f;
+    }
+    return t0;
+}
+
+// Closest-hit traversal; fills g_pickResult (face/t/u/v/point) and returns the face or -1
+inline int bvhIntersect(const float* o, const float* d, float tMin) {
+    g_pickResult.face = -1; g_pickResult.vertex = -1;
+    g_pickResult.t = 3.4e38f;
+    if (!g_bvhNodeCount) return -1;
+    float invD[3] = { 1.0f / d[0], 1.0f / d[1], 1.0f / d[2] };
+    uint32_t stack[BVH_STACK]; int sp = 0;
+    uint32_t n = 0;
+    while (true) {
+        const BVHNode& node = g_bvhNodes[n];
+        if (node.count) {
+            for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+                uint32_t f = g_bvhFaces[i];
+                const uint32_t* tri = &g_indices[f * 3];
+                const float *p0 = &g_rawVertices[tri[0] * 3], *p1 = &g_rawVertices[tri[1] * 3], *p2 = &g_rawVertices[tri[2] * 3];
+                // Moller-Trumbore (two-sided)
+                float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                float pv[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+                float det = e1[0] * pv[0] + e1[1] * pv[1] + e1[2] * pv[2];
+                if (fabsf(det) < 1e-12f) continue;
+                float invDet = 1.0f / det;
+                float tv[3] = { o[0] - p0[0], o[1] - p0[1], o[2] - p0[2] };
+                float u = (tv[0] * pv[0] + tv[1] * pv[1] + tv[2] * pv[2]) * invDet;
+                if (u < 0.0f || u > 1.0f) continue;
+                float qv[3] = { tv[1] * e1[2] - tv[2] * e1[1], tv[2] * e1[0] - tv[0] * e1[2], tv[0] * e1[1] - tv[1] * e1[0] };
+                float v = (d[0] * qv[0] + d[1] * qv[1] + d[2] * qv[2]) * invDet;
+                if (v < 0.0f || u + v > 1.0f) continue;
+                float t = (e2[0] * qv[0] + e2[1] * qv[1] + e2[2] * qv[2]) * invDet;
+                if (t < tMin || t >= g_pickResult.t) continue;
+                g_pickResult.face = f; g_pickResult.t = t; g_pickResult.u = u; g_pickResult.v = v;
+            }
+            if (sp == 0) break;
+            n = stack[--sp];
+            continue;
+        }
+        // Visit the nearer child first, defer the other
+        uint32_t c0 = node.leftFirst, c1 = node.leftFirst + 1;
+        float d0 = bvhRayBox(g_bvhNodes[c0], o, invD, g_pickResult.t);
+        float d1 = bvhRayBox(g_bvhNodes[c1], o, invD, g_pickResult.t);
+        if (d0 > d1) { std::swap(d0, d1); std::swap(c0, c1); }
+        if (d0 == 3.4e38f) {
+            if (sp == 0) break;
+            n = stack[--sp];
+            continue;
+        }
+        n = c0;
+        if (d1 != 3.4e38f) stack[sp++] = c1;
+    }
+    if (g_pickResult.face >= 0) {
+        for (int a = 0; a < 3; a++) g_pickResult.point[a] = o[a] + d[a] * g_pickResult.t;
+    }
+    return g_pickResult.face;
+}
+
+// Screen pixel -> model-space ray (view origin, direction with view z = -1 so t = view depth)
+inline bool bvhScreenRay(const float* m, float px, float py, int width, int height, float fov, float* o, float* d) {
+    float inv[16];
+    if (!invertAffine(m, inv)) return false;
+    float vx = (px - width * 0.5f) / fov, vy = -(py - height * 0.5f) / fov, vz = -1.0f;
+    for (int a = 0; a < 3; a++) {
+        o[a] = inv[12 + a];
+        d[a] = inv[a] * vx + inv[4 + a] * vy + inv[8 + a] * vz;
+    }
+    return true;
+}
+
+/**
+ * Closest-hit ray cast from a screen pixel. m = model-view matrix used for rendering.
+ * Returns the face index (or -1); details in getPickResultBuffer().
+ */
+EMSCRIPTEN_KEEPALIVE
+int bvhRaycast(float* m, float px, float py, int width, int height, float fov) {
+    float o[3], d[3];
+    g_pickResult.face = -1; g_pickResult.vertex = -1;
+    if (!bvhScreenRay(m, px, py, width, height, fov, o, d)) return -1;
+    return bvhIntersect(o, d, 0.01f); // Same near plane as projectBuffer
+}
+
+// Screen rect -> 5 model-space planes (a, b, c, d): inside when a*x + b*y + c*z + d >= 0
+inline void bvhRectPlanes(const float* m, float x0, float y0, float x1, float y1, int width, int height, float fov, float planes[5][4]) {
+    float cx = width * 0.5f, cy = height * 0.5f;
+    float view[5][4] = {
+        { fov, 0.0f, x0 - cx, 0.0f },         // sx >= x0
+        { -fov, 0.0f, -(x1 - cx), 0.0f },     // sx <= x1
+        { 0.0f, -fov, y0 - cy, 0.0f },        // sy >= y0
+        { 0.0f, fov, -(y1 - cy), 0.0f },      // sy <= y1
+        { 0.0f, 0.0f, -1.0f, -0.01f }         // near plane
+    };
+    // View plane P tested against m * x  ==  (m^T P) tested against x
+    for (int p = 0; p < 5; p++) {
+        for (int c = 0; c < 4; c++) {
+            planes[p][c] = view[p][0] * m[c * 4] + view[p][1] * m[c * 4 + 1] + view[p][2] * m[c * 4 + 2] + view[p][3] * m[c * 4 + 3];
+        }
+    }
+}
+
+// 0 = outside, 1 = intersecting, 2 = fully inside
+inline int bvhBoxVsPlanes(const BVHNode& n, const float planes[5][4]) {
+    int result = 2;
+    for (int p = 0; p < 5; p++) {
+        const float* pl = planes[p];
+        float px = pl[0] >= 0 ? n.bmax[0] : n.bmin[0], nx = pl[0] >= 0 ? n.bmin[0] : n.bmax[0];
+        float py = pl[1] >= 0 ? n.bmax[1] : n.bmin[1], ny = pl[1] >= 0 ? n.bmin[1] : n.bmax[1];
+        float pz = pl[2] >= 0 ? n.bmax[2] : n.bmin[2], nz = pl[2] >= 0 ? n.bmin[2] : n.bmax[2];
+        if (pl[0] * px + pl[1] * py + pl[2] * pz + pl[3] < 0) return 0;
+        if (pl[0] * nx + pl[1] * ny + pl[2] * nz + pl[3] < 0) result = 1;
+    }
+    return result;
+}
+
+/**
+ * Box selection: marks every face whose centroid projects inside the screen rect (in front of
+ * the near plane) and writes coalesced (startFace, faceCount) pairs to getSelectionRangesBuffer().
+ * Returns the number of ranges; the selected face total goes to g_pickResult.face.
+ */
+EMSCRIPTEN_KEEPALIVE
+int bvhSelectBox(float* m, float x0, float y0, float x1, float y1, int width, int height, float fov) {
+    g_pickResult.face = 0; g_pickResult.vertex = -1;
+    if (!g_bvhNodeCount) return 0;
+    if (x0 > x1) std::swap(x0, x1);
+    if (y0 > y1) std::swap(y0, y1);
+    float planes[5][4];
+    bvhRectPlanes(m, x0, y0, x1, y1, width, height, fov, planes);
+    memset(g_bvhSelectMask, 0, ((g_bvhFaceCount + 31) / 32) * sizeof(uint32_t));
+
+    uint32_t stack[BVH_STACK]; uint8_t inside[BVH_STACK]; int sp = 0;
+    stack[sp] = 0; inside[sp++] = 0;
+    while (sp > 0) {
+        sp--;
+        const BVHNode& node = g_bvhNodes[stack[sp]];
+        int state = inside[sp] ? 2 : bvhBoxVsPlanes(node, planes);
+        if (state == 0) continue;
+        if (!node.count) {
+            stack[sp] = node.leftFirst; inside[sp++] = state == 2;
+            stack[sp] = node.leftFirst + 1; inside[sp++] = state == 2;
+            continue;
+        }
+        for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+            uint32_t f = g_bvhFaces[i];
+            if (state == 1) {
+                const uint32_t* tri = &g_indices[f * 3];
+                const float *a = &g_rawVertices[tri[0] * 3], *b = &g_rawVertices[tri[1] * 3], *c = &g_rawVertices[tri[2] * 3];
+                float cx = (a[0] + b[0] + c[0]) * 0.333333f, cy = (a[1] + b[1] + c[1]) * 0.333333f, cz = (a[2] + b[2] + c[2]) * 0.333333f;
+                bool in = true;
+                for (int p = 0; p < 5 && in; p++) in = planes[p][0] * cx + planes[p][1] * cy + planes[p][2] * cz + planes[p][3] >= 0;
+                if (!in) continue;
+            }
+            g_bvhSelectMask[f >> 5] |= 1u << (f & 31);
+        }
+    }
+
+    // Coalesce the bitmask into face ranges
+    int rangeCount = 0;
+    uint32_t selected = 0, runStart = 0;
+    bool inRun = false;
+    for (uint32_t f = 0; f < g_bvhFaceCount; f++) {
+        uint32_t word = g_bvhSelectMask[f >> 5];
+        if (!inRun && word == 0) { f |= 31; continue; } // Skip empty words
+        bool bit = (word >> (f & 31)) & 1;
+        if (bit && !inRun) { runStart = f; inRun = true; }
+        else if (!bit && inRun) {
+            g_bvhRanges[rangeCount * 2] = runStart; g_bvhRanges[rangeCount * 2 + 1] = f - runStart;
+            selected += f - runStart; rangeCount++; inRun = false;
+        }
+    }
+    if (inRun) {
+        g_bvhRanges[rangeCount * 2] = runStart; g_bvhRanges[rangeCount * 2 + 1] = g_bvhFaceCount - runStart;
+        selected += g_bvhFaceCount - runStart; rangeCount++;
+    }
+    g_pickResult.face = selected;
+    return rangeCount;
+}
+
+/**
+ * Nearest-vertex snapping: closest vertex (screen distance) within radius pixels of (px, py).
+ * Only vertices of front-facing faces count, and a candidate must be visible from the eye (shadow
+ * ray through the BVH), so snapping never goes through the mesh, even when the cursor misses it.
+ * Returns the vertex index or -1; the model-space position goes to g_pickResult.point.
+ */
+EMSCRIPTEN_KEEPALIVE
+int bvhSnapVertex(float* m, float px, float py, float radius, int width, int height, float fov) {
+    int hitFace = bvhRaycast(m, px, py, width, height, fov);
+    float maxDepth = hitFace >= 0 ? g_pickResult.t * 1.01f + 1e-4f : 3.4e38f;
+    float hit[3] = { g_pickResult.point[0], g_pickResult.point[1], g_pickResult.point[2] };
+    g_pickResult.vertex = -1;
+    float inv[16];
+    if (!g_bvhNodeCount || !invertAffine(m, inv)) return -1;
+    const float eye[3] = { inv[12], inv[13], inv[14] };
+
+    float planes[5][4];
+    bvhRectPlanes(m, px - radius, py - radius, px + radius, py + radius, width, height, fov, planes);
+    float cx = width * 0.5f, cy = height * 0.5f;
+    float bestDist = radius * radius, bestDepth = 3.4e38f;
+    int best = -1;
+
+    uint32_t stack[BVH_STACK]; int sp = 0;
+    stack[sp++] = 0;
+    while (sp > 0) {
+        const BVHNode& node = g_bvhNodes[stack[--sp]];
+        if (!bvhBoxVsPlanes(node, planes)) continue;
+        if (!node.count) {
+            stack[sp++] = node.leftFirst;
+            stack[sp++] = node.leftFirst + 1;
+            continue;
+        }
+        for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+            const uint32_t* tri = &g_indices[g_bvhFaces[i] * 3];
+            float sx[3], sy[3], depth[3];
+            bool inFront = true;
+            for (int k = 0; k < 3 && inFront; k++) {
+                const float* v = &g_rawVertices[tri[k] * 3];
+                float vx = m[0] * v[0] + m[4] * v[1] + m[8] * v[2] + m[12];
+                float vy = m[1] * v[0] + m[5] * v[1] + m[9] * v[2] + m[13];
+                float vz = m[2] * v[0] + m[6] * v[1] + m[10] * v[2] + m[14];
+                inFront = vz <= -0.01f;
+                float invW = 1.0f / -vz;
+                sx[k] = vx * fov * invW + cx; sy[k] = -vy * fov * invW + cy; depth[k] = -vz;
+            }
+            // Same winding rule as the rasterizer: back faces hide their vertices
+            if (!inFront || (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sy[1] - sy[0]) * (sx[2] - sx[0]) >= 0.0f) continue;
+            for (int k = 0; k < 3; k++) {
+                if (depth[k] > maxDepth) continue;
+                float dx = sx[k] - px, dy = sy[k] - py;
+                float dist = dx * dx + dy * dy;
+                if (!(dist < bestDist || (dist == bestDist && depth[k] < bestDepth)) || (int)tri[k] == best) continue;
+                // Shadow ray eye -> vertex (t = 1 at the vertex): anything hit before it occludes
+                const float* v = &g_rawVertices[tri[k] * 3];
+                float d[3] = { v[0] - eye[0], v[1] - eye[1], v[2] - eye[2] };
+                if (bvhIntersect(eye, d, 0.0f) >= 0 && g_pickResult.t < 0.999f) continue;
+                bestDist = dist; bestDepth = depth[k]; best = (int)tri[k];
+            }
+        }
+    }
+
+    g_pickResult.vertex = best;
+    if (best >= 0) {
+        for (int a = 0; a < 3; a++) g_pickResult.point[a] = g_rawVertices[best * 3 + a];
+    } else {
+        for (int a = 0; a < 3; a++) g_pickResult.point[a] = hit[a];
+    }
+    return best;
+}
+
 // --- RADIX SORT ---
 
 EMSCRIPTEN_KEEPALIVE
@@ -463,9 +1267,11 @@ void radixSort(uint32_t* indices, float* depths, int count, uint32_t* auxIndices
 /**
  * Deterministic drawLineInternal: Uses periodic dashing for line density
  * density: 1.0 = solid, 0.5 = 50% dash, etc.
+ * (ox, oy): global pixel of the framebuffer origin; lines are clipped to [ox, ox + width) x [oy, oy + height).
  */
-inline void drawLineInternal(Pixel* pixels, int width, int height, float x0, float y0, float z0, float x1, float y1, float z1, uint32_t color, float density) {
-    int ix0 = (int)x0, iy0 = (int)y0, ix1 = (int)x1, iy1 = (int)y1;
+inline void drawLineInternal(Pixel* pixels, int ox, int oy, int width, int height, float x0, float y0, float z0, float x1, float y1, float z1, uint32_t color, float density) {
+    // floorf, not (int): truncation shifts lines that start off-screen (negative coords) by a pixel
+    int ix0 = (int)floorf(x0), iy0 = (int)floorf(y0), ix1 = (int)floorf(x1), iy1 = (int)floorf(y1);
     int dx = abs(ix1 - ix0), dy = abs(iy1 - iy0);
     int sx = ix0 < ix1 ? 1 : -1, sy = iy0 < iy1 ? 1 : -1;
     int err = dx - dy, totalSteps = std::max(dx, dy);
@@ -478,8 +1284,9 @@ inline void drawLineInternal(Pixel* pixels, int width, int height, float x0, flo
     for (int i = 0; i <= totalSteps; i++) {
         // Deterministic Dashing: Draw segment, skip segment
         if ((i % dashPeriod) < dashThreshold) {
-            if (ix0 >= 0 && ix0 < width && iy0 >= 0 && iy0 < height) {
-                Pixel& p = pixels[iy0 * FB_WIDTH + ix0];
+            int px = ix0 - ox, py = iy0 - oy;
+            if (px >= 0 && px < width && py >= 0 && py < height) {
+                Pixel& p = pixels[py * FB_WIDTH + px];
                 if (z >= p.depth - 0.01f) { 
                     p.depth = z; 
                     p.color = color; 
@@ -495,18 +1302,22 @@ inline void drawLineInternal(Pixel* pixels, int width, int height, float x0, flo
     }
 }
 
-EMSCRIPTEN_KEEPALIVE
-void renderWireframe(Pixel* pixels, float* screen, uint32_t* indices, uint32_t* sortedIndices, int fCount, uint32_t color, int width, int height, float density) {
+inline void renderWireframeAt(Pixel* pixels, float* screen, uint32_t* indices, uint32_t* sortedIndices, int fCount, uint32_t color, int ox, int oy, int width, int height, float density) {
     for (int i = 0; i < fCount; i++) {
         int idx = sortedIndices[i];
         int i3 = idx * 3, i0 = indices[i3], i1 = indices[i3 + 1], i2 = indices[i3 + 2], i04 = i0 << 2, i14 = i1 << 2, i24 = i2 << 2;
         
-        drawLineInternal(pixels, width, height, screen[i04], screen[i04+1], screen[i04+2], screen[i14], screen[i14+1], screen[i14+2], color, density);
-        drawLineInternal(pixels, width, height, screen[i14], screen[i14+1], screen[i14+2], screen[i24], screen[i24+1], screen[i24+2], color, density);
-        drawLineInternal(pixels, width, height, screen[i24], screen[i24+1], screen[i24+2], screen[i04], screen[i04+1], screen[i04+2], color, density);
+        drawLineInternal(pixels, ox, oy, width, height, screen[i04], screen[i04+1], screen[i04+2], screen[i14], screen[i14+1], screen[i14+2], color, density);
+        drawLineInternal(pixels, ox, oy, width, height, screen[i14], screen[i14+1], screen[i14+2], screen[i24], screen[i24+1], screen[i24+2], color, density);
+        drawLineInternal(pixels, ox, oy, width, height, screen[i24], screen[i24+1], screen[i24+2], screen[i04], screen[i04+1], screen[i04+2], color, density);
     }
 }
 
+EMSCRIPTEN_KEEPALIVE
+void renderWireframe(Pixel* pixels, float* screen, uint32_t* indices, uint32_t* sortedIndices, int fCount, uint32_t color, int width, int height, float density) {
+    renderWireframeAt(pixels, screen, indices, sortedIndices, fCount, color, 0, 0, width, height, density);
+}
+
 EMSCRIPTEN_KEEPALIVE
 void renderBatch(Pixel* pixels, float* screen, uint32_t* indices, uint32_t* sortedIndices, float* intensities, uint32_t* faceColors, int fCount, uint32_t baseColor, int width, int height, bool isUV) {
     // Extract RGB from 0xFFRRGGBB (The JS WASM Color)
@@ -552,10 +1363,10 @@ void renderBatch(Pixel* pixels, float* screen, uint32_t* indices, uint32_t* sort
 
 // --- TILED PARALLEL ARCHITECTURE ---
 
-EMSCRIPTEN_KEEPALIVE
-void binFaces(
+// (ox, oy): global pixel of tile 0; screen coordinates are global, tiles cover [ox, ox + width) x [oy, oy + height)
+inline void binFacesAt(
     Tile* tiles, float* screen, uint32_t* indices, uint32_t* sortedIndices, 
-    int validCount, int width, int height
+    int validCount, int ox, int oy, int width, int height
 ) {
     int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
     int tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
@@ -569,9 +1380,9 @@ void binFaces(
         int i0 = indices[i3], i1 = indices[i3+1], i2 = indices[i3+2];
         int i04 = i0 << 2, i14 = i1 << 2, i24 = i2 << 2;
 
-        float x0 = screen[i04], y0 = screen[i04+1];
-        float x1 = screen[i14], y1 = screen[i14+1];
-        float x2 = screen[i24], y2 = screen[i24+1];
+        float x0 = screen[i04] - ox, y0 = screen[i04+1] - oy;
+        float x1 = screen[i14] - ox, y1 = screen[i14+1] - oy;
+        float x2 = screen[i24] - ox, y2 = screen[i24+1] - oy;
 
         int minTx = (int)(std::min({x0, x1, x2}) / TILE_SIZE);
         int maxTx = (int)(std::max({x0, x1, x2}) / TILE_SIZE);
@@ -592,18 +1403,26 @@ void binFaces(
     }
 }
 
-inline void drawSpanTile(Pixel* pixels, int y, int fx1, int fx2, int fz1, int fz2, float fi1, float fi2, uint32_t color, int width, int height, int minX, int maxX) {
-    if (y < 0 || y >= height) return;
+EMSCRIPTEN_KEEPALIVE
+void binFaces(
+    Tile* tiles, float* screen, uint32_t* indices, uint32_t* sortedIndices, 
+    int validCount, int width, int height
+) {
+    binFacesAt(tiles, screen, indices, sortedIndices, validCount, 0, 0, width, height);
+}
+
+// row: framebuffer row of this scanline; ox: global x of its first pixel. [minX, maxX) is global.
+inline void drawSpanTile(Pixel* row, int ox, int64_t fx1, int64_t fx2, int64_t fz1, int64_t fz2, float fi1, float fi2, uint32_t color, int minX, int maxX) {
     if (fx1 > fx2) { std::swap(fx1, fx2); std::swap(fz1, fz2); std::swap(fi1, fi2); }
     
-    int xStart = std::max(minX, (fx1 + f_one - 1) >> f_shift);
-    int xEnd = std::min(maxX, (fx2 + f_one - 1) >> f_shift);
+    int64_t xStart = std::max((int64_t)minX, (fx1 + f_one - 1) >> f_shift);
+    int64_t xEnd = std::min((int64_t)maxX, (fx2 + f_one - 1) >> f_shift);
     
     if (xStart >= xEnd) return;
     
     float zStart = (float)fz1 / f_one;
     float zEnd = (float)fz2 / f_one;
-    int dx = fx2 - fx1;
+    int64_t dx = fx2 - fx1;
     
     float weight = (dx > 0) ? (float)((xStart << f_shift) - fx1) / dx : 0;
     float dz = (dx > 0) ? (zEnd - zStart) * f_one / dx : 0;
@@ -614,8 +1433,8 @@ inline void drawSpanTile(Pixel* pixels, int y, int fx1, int fx2, int fz1, int fz
 
     uint8_t r_src = (color >> 16) & 0xFF, g_src = (color >> 8) & 0xFF, b_src = color & 0xFF;
 
-    Pixel* p = &pixels[y * FB_WIDTH + xStart];
-    for (int x = xStart; x < xEnd; x++) {
+    Pixel* p = &row[xStart - ox];
+    for (int64_t x = xStart; x < xEnd; x++) {
         if (z > p->depth) {
             p->depth = z;
             uint8_t r = (uint8_t)(r_src * intens), g = (uint8_t)(g_src * intens), b = (uint8_t)(b_src * intens);
@@ -627,18 +1446,20 @@ inline void drawSpanTile(Pixel* pixels, int y, int fx1, int fx2, int fz1, int fz
     }
 }
 
-EMSCRIPTEN_KEEPALIVE
-void renderTile(
+// Tile bounds are global ((ox, oy) = global pixel of the framebuffer origin, as in binFacesAt).
+// Spans clip against the tile, so output only matches a single pass when (ox, oy) lie on the
+// TILE_SIZE grid: then every tile, and every span start inside it, is the same in both.
+inline void renderTileAt(
     Pixel* pixels, Tile* tiles, int tileIdx, float* screen, uint32_t* indices, 
     float* intensities, uint32_t* faceColors, uint32_t baseColor, 
-    int width, int height, bool isUV
+    int ox, int oy, int width, int height, bool isUV
 ) {
     Tile& t = tiles[tileIdx];
     int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
     int tx = tileIdx % tilesX;
     int ty = tileIdx / tilesX;
-    int minX = tx * TILE_SIZE, maxX = std::min(width, (tx + 1) * TILE_SIZE);
-    int minY = ty * TILE_SIZE, maxY = std::min(height, (ty + 1) * TILE_SIZE);
+    int minX = ox + tx * TILE_SIZE, maxX = ox + std::min(width, (tx + 1) * TILE_SIZE);
+    int minY = oy + ty * TILE_SIZE, maxY = oy + std::min(height, (ty + 1) * TILE_SIZE);
 
     // Extract RGB from 0xFFRRGGBB (Corrected extraction)
     uint8_t r_src = (baseColor >> 16) & 0xFF;
@@ -678,7 +1499,7 @@ void renderTile(
         if ((fMaxX - fMinX) < 1.0f && (fMaxY - fMinY) < 1.0f) {
             int px = (int)x0, py = (int)y0;
             if (px >= minX && px < maxX && py >= minY && py < maxY) {
-                Pixel& p = pixels[py * FB_WIDTH + px];
+                Pixel& p = pixels[(py - oy) * FB_WIDTH + (px - ox)];
                 if (z0 > p.depth) { 
                     p.depth = z0; 
                     float avgIn = (in0 + in1 + in2) * 0.333333f;
@@ -706,9 +1527,9 @@ void renderTile(
             int startY = std::max(minY, iy0), endY = std::min(maxY, iy1);
             for (int y = startY; y < endY; y++) {
                 float dy = (float)y - y0;
-                drawSpanTile(pixels, y, (int)((x0 + dy * dx01) * f_one), (int)((x0 + dy * dx02) * f_one), 
-                                   (int)((z0 + dy * dz01) * f_one), (int)((z0 + dy * dz02) * f_one), 
-                                   (in0 + dy * di01), (in0 + dy * di02), effectiveColor, width, height, minX, maxX);
+                drawSpanTile(&pixels[(y - oy) * FB_WIDTH], ox, toFixed(x0 + dy * dx01), toFixed(x0 + dy * dx02), 
+                                   toFixed(z0 + dy * dz01), toFixed(z0 + dy * dz02), 
+                                   (in0 + dy * di01), (in0 + dy * di02), effectiveColor, minX, maxX);
             }
         }
         if (iy1 < iy2) {
@@ -717,18 +1538,27 @@ void renderTile(
             int startY = std::max(minY, iy1), endY = std::min(maxY, iy2);
             for (int y = startY; y < endY; y++) {
                 float dyBot = (float)y - y1, dyTop = (float)y - y0;
-                drawSpanTile(pixels, y, (int)((x1 + dyBot * dx12) * f_one), (int)((x0 + dyTop * dx02) * f_one), 
-                                   (int)((z1 + dyBot * dz12) * f_one), (int)((z0 + dyTop * dz02) * f_one), 
-                                   (in1 + dyBot * di12), (in0 + dyTop * di02), effectiveColor, width, height, minX, maxX);
+                drawSpanTile(&pixels[(y - oy) * FB_WIDTH], ox, toFixed(x1 + dyBot * dx12), toFixed(x0 + dyTop * dx02), 
+                                   toFixed(z1 + dyBot * dz12), toFixed(z0 + dyTop * dz02), 
+                                   (in1 + dyBot * di12), (in0 + dyTop * di02), effectiveColor, minX, maxX);
             }
         }
     }
     // Only print for first tile to avoid spam
-    if (tileIdx == 0 && t.faceCount > 0) {
+    if (g_debug && tileIdx == 0 && t.faceCount > 0) {
         printf("[DEUS-W] Tile 0 rendered %d faces.\n", t.faceCount);
     }
 }
 
+EMSCRIPTEN_KEEPALIVE
+void renderTile(
+    Pixel* pixels, Tile* tiles, int tileIdx, float* screen, uint32_t* indices, 
+    float* intensities, uint32_t* faceColors, uint32_t baseColor, 
+    int width, int height, bool isUV
+) {
+    renderTileAt(pixels, tiles, tileIdx, screen, indices, intensities, faceColors, baseColor, 0, 0, width, height, isUV);
+}
+
 EMSCRIPTEN_KEEPALIVE
 void extractColors(Pixel* pixels, uint32_t* out, int width, int height) {
     for (int y = 0; y < height; y++) {
@@ -738,6 +1568,75 @@ void extractColors(Pixel* pixels, uint32_t* out, int width, int height) {
     }
 }
 
+// --- DYNAMIC RESOLUTION: SIMD BILINEAR UPSCALE ---
+
+inline v128_t unpackColor(uint32_t c) {
+    v128_t v = wasm_i32x4_splat((int32_t)c);
+    v = wasm_u16x8_extend_low_u8x16(v);
+    v = wasm_u32x4_extend_low_u16x8(v);
+    return wasm_f32x4_convert_u32x4(v); // r, g, b, a lanes
+}
+
+// Straight -> premultiplied alpha, so cleared (a = 0) texels carry no colour into the blend
+inline v128_t premultiply(v128_t c) {
+    float s = wasm_f32x4_extract_lane(c, 3) * (1.0f / 255.0f);
+    return wasm_f32x4_mul(c, wasm_f32x4_make(s, s, s, 1.0f));
+}
+
+inline v128_t unpremultiply(v128_t c) {
+    float a = wasm_f32x4_extract_lane(c, 3);
+    float s = a > 0.0f ? 255.0f / a : 0.0f;
+    return wasm_f32x4_mul(c, wasm_f32x4_make(s, s, s, 1.0f));
+}
+
+inline uint32_t packColor(v128_t f) {
+    v128_t i = wasm_i32x4_trunc_sat_f32x4(wasm_f32x4_add(f, wasm_f32x4_splat(0.5f)));
+    v128_t s = wasm_u16x8_narrow_i32x4(i, i);
+    return (uint32_t)wasm_i32x4_extract_lane(wasm_u8x16_narrow_i16x8(s, s), 0);
+}
+
+/**
+ * Bilinear upscale of the reduced-resolution colour plane (srcW x srcH inside the tiled
+ * framebuffer) into a dstW x dstH presentation buffer. One pixel per iteration, all four
+ * channels in one f32x4; column taps/weights are precomputed once per call. Filtering is done
+ * in premultiplied alpha: silhouette pixels fade out instead of darkening toward the clear colour.
+ */
+EMSCRIPTEN_KEEPALIVE
+void upscaleColors(Pixel* pixels, int srcW, int srcH, uint32_t* out, int dstW, int dstH) {
+    static int32_t tapX0[PRESENT_MAX_WIDTH], tapX1[PRESENT_MAX_WIDTH];
+    static float weightX[PRESENT_MAX_WIDTH];
+    if (dstW > PRESENT_MAX_WIDTH) dstW = PRESENT_MAX_WIDTH;
+    if (dstH > PRESENT_MAX_HEIGHT) dstH = PRESENT_MAX_HEIGHT;
+
+    float scaleX = (float)srcW / dstW, scaleY = (float)srcH / dstH;
+    for (int x = 0; x < dstW; x++) {
+        float fx = std::max(0.0f, (x + 0.5f) * scaleX - 0.5f);
+        int ix = std::min((int)fx, srcW - 1);
+        tapX0[x] = ix;
+        tapX1[x] = std::min(ix + 1, srcW - 1);
+        weightX[x] = fx - ix;
+    }
+
+    for (int y = 0; y < dstH; y++) {
+        float fy = std::max(0.0f, (y + 0.5f) * scaleY - 0.5f);
+        int iy = std::min((int)fy, srcH - 1);
+        const Pixel* row0 = &pixels[iy * FB_WIDTH];
+        const Pixel* row1 = &pixels[std::min(iy + 1, srcH - 1) * FB_WIDTH];
+        v128_t wy = wasm_f32x4_splat(fy - iy);
+        uint32_t* dst = &out[y * dstW];
+
+        for (int x = 0; x < dstW; x++) {
+            int x0 = tapX0[x], x1 = tapX1[x];
+            v128_t wx = wasm_f32x4_splat(weightX[x]);
+            v128_t a = premultiply(unpackColor(row0[x0].color)), b = premultiply(unpackColor(row0[x1].color));
+            v128_t c = premultiply(unpackColor(row1[x0].color)), d = premultiply(unpackColor(row1[x1].color));
+            v128_t top = wasm_f32x4_add(a, wasm_f32x4_mul(wasm_f32x4_sub(b, a), wx));
+            v128_t bot = wasm_f32x4_add(c, wasm_f32x4_mul(wasm_f32x4_sub(d, c), wx));
+            dst[x] = packColor(unpremultiply(wasm_f32x4_add(top, wasm_f32x4_mul(wasm_f32x4_sub(bot, top), wy))));
+        }
+    }
+}
+
 EMSCRIPTEN_KEEPALIVE
 void clearBuffers(Pixel* pixels, int width, int height) {
     for (int y = 0; y < height; y++) {
@@ -749,10 +1648,166 @@ void clearBuffers(Pixel* pixels, int width, int height) {
     }
 }
 
+// --- OFFLINE TILED RENDERER (ARBITRARY OUTPUT SIZE) ---
+// Stills larger than the framebuffer are rendered as REGION_WIDTH x REGION_HEIGHT regions. Each
+// region projects the resident mesh into image-global coordinates, culls clusters/faces against its
+// own rect, and bins/rasterizes only that rect into the framebuffer, so a tile-aligned mosaic is
+// bit-identical to one pass. Peak memory is the framebuffer plus one region of colour.
+// Coordinate cap: spans are 64-bit 16.16 (toFixed), so the limit is float screen precision
+// (1/16 px up to 2^19 px per side), not fixed-point overflow.
+
+/**
+ * Renders region [originX, originX + regionW) x [originY, originY + regionH) of an outW x outH image
+ * from g_rawVertices/g_indices. useClusters: g_clusters were uploaded for this same mesh (culled per
+ * region); otherwise every face is tested. m is the model-view matrix.
+ * Colours go to out with row stride outStride (regionW for a packed region; the image width when
+ * regions are assembled in place, e.g. live stills larger than the framebuffer). Returns faces drawn.
+ * Origins on the TILE_SIZE grid make the assembled image identical to a single-pass render.
+ */
+EMSCRIPTEN_KEEPALIVE
+int renderRegion(
+    float* m, int vCount, int fCount, bool useClusters, int outW, int outH,
+    int originX, int originY, int regionW, int regionH, float fov,
+    float lx, float ly, float lz, bool isWire, bool isUV, bool isNormal, bool overlayWire,
+    uint32_t baseColor, uint32_t wireColor, uint32_t* out, int outStride
+) {
+    regionW = std::min(regionW, FB_WIDTH);
+    regionH = std::min(regionH, FB_HEIGHT);
+    float cx = outW * 0.5f, cy = outH * 0.5f;
+
+    // View space is rebuilt per region: live frames may reuse g_world in between
+    transformBuffer(g_world, g_rawVertices, m, vCount);
+    projectBufferAt(g_screen, g_world, vCount, cx, cy, fov);
+
+    int validCount = 0;
+    if (useClusters && g_clusterCount > 0) {
+        for (int c = 0; c < g_clusterCount; c++) {
+            const Cluster& cl = g_clusters[c];
+            // Region rect grown by 1 px: the box projection rounds differently from projectBufferAt
+            if (testClusterAt(cl, m, regionW + 2, regionH + 2, fov, cx - originX + 1, cy - originY + 1, false) != CLUSTER_VISIBLE) continue;
+            validCount = emitFaceRange(cl.startFace, cl.startFace + cl.faceCount, 1, g_screen, g_world, g_indices, g_depths,
+                                       g_sortedIndices, g_intensities, g_faceColors, validCount, lx, ly, lz,
+                                       isWire, isUV, isNormal, originX, originY, regionW, regionH);
+        }
+    } else {
+        validCount = emitFaceRange(0, fCount, 1, g_screen, g_world, g_indices, g_depths, g_sortedIndices, g_intensities,
+                                   g_faceColors, 0, lx, ly, lz, isWire, isUV, isNormal, originX, originY, regionW, regionH);
+    }
+
+    radixSort(g_sortedIndices, g_depths, validCount, g_auxIndices, g_auxDepths, g_radixCounts);
+    clearBuffers(g_pixels, regionW, regionH);
+    if (!isWire) {
+        binFacesAt(g_tiles, g_screen, g_indices, g_sortedIndices, validCount, originX, originY, regionW, regionH);
+        int tileCount = ((regionW + TILE_SIZE - 1) / TILE_SIZE) * ((regionH + TILE_SIZE - 1) / TILE_SIZE);
+        for (int t = 0; t < tileCount; t++) {
+            renderTileAt(g_pixels, g_tiles, t, g_screen, g_indices, g_intensities, g_faceColors, baseColor,
+                         originX, originY, regionW, regionH, isUV || isNormal);
+        }
+    }
+    if (isWire || overlayWire) {
+        renderWireframeAt(g_pixels, g_screen, g_indices, g_sortedIndices, validCount, wireColor, originX, originY, regionW, regionH, 1.0f);
+    }
+    for (int y = 0; y < regionH; y++) extractColors(&g_pixels[y * FB_WIDTH], &out[y * outStride], regionW, 1);
+    return validCount;
+}
+
+#ifdef __EMSCRIPTEN__
 EMSCRIPTEN_KEEPALIVE
 void* malloc(size_t size) { return ::malloc(size); }
 EMSCRIPTEN_KEEPALIVE
 void free(void* ptr) { ::free(ptr); }
+#else
+// --- NATIVE OFFLINE ENTRY (HEADLESS BENCHMARK / TEST HARNESS) ---
+// The harness copies the mesh into getRawVerticesBuffer()/getIndicesBuffer() (and optionally
+// uploadClusters, then useClusters = true), then calls renderOffline with a row sink.
+
+// Returns false to abort the render (e.g. a write failed)
+typedef bool (*OfflineRowSink)(void* user, int x, int y, int width, const uint32_t* rgba);
+
+/**
+ * Renders an outW x outH still region by region (row-major, REGION_WIDTH x REGION_HEIGHT each) and hands
+ * every finished row span to sink. Spans arrive per region, so sinks must place them by (x, y).
+ * Pixels are 0xAABBGGRR (RGBA bytes). Returns the total number of faces drawn over all regions,
+ * or -1 if the sink aborted.
+ */
+int renderOffline(
+    float* m, int vCount, int fCount, bool useClusters, int outW, int outH, float fov,
+    float lx, float ly, float lz, bool isWire, bool isUV, bool isNormal, bool overlayWire,
+    uint32_t baseColor, uint32_t wireColor, OfflineRowSink sink, void* user
+) {
+    int faces = 0;
+    uint32_t* region = g_outFB[0];
+    for (int oy = 0; oy < outH; oy += REGION_HEIGHT) {
+        for (int ox = 0; ox < outW; ox += REGION_WIDTH) {
+            int rw = std::min(REGION_WIDTH, outW - ox), rh = std::min(REGION_HEIGHT, outH - oy);
+            faces += renderRegion(m, vCount, fCount, useClusters, outW, outH, ox, oy, rw, rh, fov, lx, ly, lz,
+                                  isWire, isUV, isNormal, overlayWire, baseColor, wireColor, region, rw);
+            for (int y = 0; y < rh; y++) {
+                if (!sink(user, ox, oy + y, rw, &region[y * rw])) return -1;
+            }
+        }
+    }
+    return faces;
+}
+
+#ifdef _WIN32
+#define PPM_SEEK _fseeki64
+#else
+#define PPM_SEEK fseeko
+#endif
+
+struct PPMSink {
+    FILE* file;
+    long long header;
+    int width;
+    bool failed; // A seek or write failed; the file is incomplete
+    uint8_t rgb[FB_WIDTH * 3];
+};
+
+// Binary PPM has a fixed 3 bytes/pixel, so out-of-order spans are written in place (seek).
+// Returns nullptr if the file cannot be created or the header cannot be written.
+PPMSink* openPPMSink(const char* path, int width, int height) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return nullptr;
+    PPMSink* s = (PPMSink*)malloc(sizeof(PPMSink));
+    int header = s ? fprintf(f, "P6\n%d %d\n255\n", width, height) : -1;
+    if (header < 0) {
+        free(s);
+        fclose(f);
+        return nullptr;
+    }
+    s->file = f;
+    s->header = header;
+    s->width = width;
+    s->failed = false;
+    return s;
+}
+
+// OfflineRowSink: returns false (and marks the sink failed) when the span cannot be written
+bool ppmSinkRow(void* user, int x, int y, int width, const uint32_t* rgba) {
+    PPMSink* s = (PPMSink*)user;
+    for (int i = 0; i < width; i++) {
+        uint32_t c = rgba[i];
+        s->rgb[i * 3] = c & 0xFF;
+        s->rgb[i * 3 + 1] = (c >> 8) & 0xFF;
+        s->rgb[i * 3 + 2] = (c >> 16) & 0xFF;
+    }
+    if (PPM_SEEK(s->file, s->header + ((long long)y * s->width + x) * 3, SEEK_SET) != 0 ||
+        fwrite(s->rgb, 3, width, s->file) != (size_t)width) {
+        s->failed = true;
+    }
+    return !s->failed;
+}
+
+// Flushes and closes the file. Returns false if any write (or the final flush) failed.
+bool closePPMSink(PPMSink* s) {
+    if (!s) return false;
+    bool ok = !s->failed;
+    ok &= fclose(s->file) == 0;
+    free(s);
+    return ok;
+}
+#endif
 
 #ifdef __cplusplus
 }
@@ -70,6 +70,33 @@
                     vboHud.style.color = "rgba(255,255,255,0.2)";
                 }
 
+                // Two-phase occlusion savings (culled clusters / total)
+                const occHud = document.getElementById('hud-occ');
+                const WASM = window.ENGINE.RasterizerWASM;
+                const occ = WASM && WASM.getOcclusionStats ? WASM.getOcclusionStats() : null;
+                if (occHud) {
+                    if (occ && occ.clusters > 0) {
+                        const culled = occ.occluded + occ.frustum;
+                        occHud.textContent = `${Math.round(culled * 100 / occ.clusters)}%`;
+                        occHud.title = `Occluded: ${occ.occluded} | Frustum: ${occ.frustum} | Drawn: ${occ.phase1}+${occ.phase2} of ${occ.clusters} clusters | Faces skipped: ${occ.culledFaces}`;
+                    } else {
+                        occHud.textContent = "N/A";
+                    }
+                }
+                if (occ && occ.clusters > 0) {
+                    window.ENGINE.Store.dispatch({ type: 'UPDATE_STATS', payload: { occlusion: occ } });
+                }
+
+                // Dynamic resolution: current internal scale and the smoothed cost steering it
+                const resHud = document.getElementById('hud-res');
+                const Scaler = window.ENGINE.ResolutionScaler;
+                if (resHud && Scaler) {
+                    const capped = Scaler.getCapped();
+                    resHud.textContent = `${Math.round(Scaler.getScale() * 100)}%${capped ? '*' : ''}`;
+                    resHud.title = `Internal render scale | Interaction cost: ${Scaler.getSmoothedMs().toFixed(1)}ms (target ${state.config.targetFrameMs}ms)` +
+                        (capped ? ` | * capped by the ${capped === 'framebuffer' ? 'tiled framebuffer' : 'presentation plane'} size` : '');
+                }
+
                 frameCount = 0;
                 lastTime = now;
             }
@@ -111,7 +138,10 @@
         const store = window.ENGINE.Store;
         // Initialize WASM Manifold
         if (window.ENGINE.RasterizerWASM) {
-            window.ENGINE.RasterizerWASM.init();
+            window.ENGINE.RasterizerWASM.init().then(() => {
+                if (window.ENGINE.FramePipeline) window.ENGINE.FramePipeline.init(document.getElementById('present'));
+                if (window.ENGINE.MeshPicker) window.ENGINE.MeshPicker.prepare(); // Model loaded before the core was
+            });
         }
 
         store.dispatch({
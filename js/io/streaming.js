@@ -69,7 +69,9 @@ window.ENGINE.StreamingTransfer = (function () {
 
                         const stabilized = window.ENGINE.Parser.finalizeManifold(vFlat, iFlat, false);
 
-                        // Cluster Partitioning (Pre-Cache)
+                        // Cluster Partitioning (Pre-Cache): faces are Morton-ordered in place first,
+                        // so the dispatched model is already in the order the clusters address
+                        window.ENGINE.Optimizer.mortonSortFaces(stabilized.vertices, stabilized.indices);
                         const clusters = window.ENGINE.Optimizer.buildClusters(stabilized.vertices, stabilized.indices, 128);
 
                         store.dispatch({
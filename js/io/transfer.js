@@ -51,6 +51,9 @@ window.ENGINE.Transfer = (function () {
 
                     if (model.vertices.length === 0) throw new Error("Parsed model is empty");
 
+                    // Face order becomes Morton order here, before anything holds the indices:
+                    // clusters (and the whole engine) see the sorted mesh
+                    window.ENGINE.Optimizer.mortonSortFaces(model.vertices, model.indices);
                     const clusters = window.ENGINE.Optimizer.buildClusters(model.vertices, model.indices, 128);
 
                     store.dispatch({
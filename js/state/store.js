@@ -47,7 +47,13 @@ window.ENGINE = window.ENGINE || {};
             wireDensity: 1.0, // Full wireframe density (100%)
             viewMode: 'SHADED_WIRE',
             fov: 45,
-            pointBudget: 20000
+            pointBudget: 20000,
+            occlusionCulling: true, // Two-phase Hi-Z cluster culling (solid WASM path)
+            pipelined: true, // Frame worker + OffscreenCanvas presentation when isolation allows
+            dynamicResolution: true, // Scale internal resolution during interaction to hold targetFrameMs
+            targetFrameMs: 16.7,
+            minRenderScale: 0.5,
+            maxRenderScale: 1.0
         },
         ui: {
             isSidebarCollapsed: false,
@@ -134,6 +140,7 @@ window.ENGINE = window.ENGINE || {};
                     object: {
                         ...state.object,
                         edges: data.edges || null,
+                        // Generator order (ring by ring) is spatially coherent enough: no Morton pass
                         clusters: action.payload.clusters || window.ENGINE.Optimizer.buildClusters(data.vertices, data.indices, 128)
                     },
                     ui: {
@@ -43,6 +43,9 @@ window.ENGINE.UI = {
         if (rBtn && rS) rBtn.addEventListener('click', () => {
             const state = store.getState();
             const optimized = window.ENGINE.Optimizer.cluster(state.vertices, state.indices, parseFloat(rS.value));
+            // Fresh arrays: Morton-order the faces before dispatch, like the file loaders
+            window.ENGINE.Optimizer.mortonSortFaces(optimized.vertices, optimized.indices);
+            optimized.clusters = window.ENGINE.Optimizer.buildClusters(optimized.vertices, optimized.indices, 128);
             store.dispatch({ type: 'SET_MODEL', payload: optimized });
         });
 
@@ -0,0 +1,165 @@
+/**
+ * Offline stills must hand the shared heap back to live frames.
+ * Loads config.js, the WASM wrapper and offlineRenderer.js into a browser-like context over a mock
+ * module whose heap layout matches the real one; its renderRegion is a stand-in that fills the
+ * region with a digest of the resident mesh, so "the live frame" is a function of the heap.
+ *
+ * Run: node tests/offlineRenderer.test.js
+ */
+'use strict';
+const assert = require('node:assert');
+const fs = require('node:fs');
+const path = require('node:path');
+const vm = require('node:vm');
+
+const ROOT = path.join(__dirname, '..');
+const MAX_VERTICES = 4096, MAX_FACES = 8192;
+
+function createModule() {
+    const heap = new ArrayBuffer(64 << 20);
+    let top = 16;
+    const alloc = (bytes) => { const p = top; top = (top + bytes + 15) & ~15; return p; };
+    const buf = {
+        pixels: alloc(2560 * 1600 * 8), rawVertices: alloc(MAX_VERTICES * 12), world: alloc(MAX_VERTICES * 16),
+        screen: alloc(MAX_VERTICES * 16), indices: alloc(MAX_FACES * 12), intensities: alloc(MAX_FACES * 4),
+        vertexIntensities: alloc(MAX_VERTICES * 4), faceColors: alloc(MAX_FACES * 4), depths: alloc(MAX_FACES * 4),
+        sortedIndices: alloc(MAX_FACES * 4), auxIndices: alloc(MAX_FACES * 4), auxDepths: alloc(MAX_FACES * 4),
+        radixCounts: alloc(1024), matrix: alloc(64), tiles: alloc(1024), outFB: alloc(2560 * 1536 * 4)
+    };
+    const freeBase = top;
+    let clusters = new Uint8Array(0); // g_clusters: uploadClusters copies, as the C++ side does
+
+    // FNV-1a over what renderRegion reads: the matrix, and vertices, indices and (if used) clusters of the resident mesh
+    function digest(m, vCount, fCount, useClusters) {
+        let h = 0x811c9dc5;
+        const mix = (bytes) => { for (let i = 0; i < bytes.length; i++) h = Math.imul(h ^ bytes[i], 0x01000193); };
+        mix(new Uint8Array(heap, m, 64));
+        mix(new Uint8Array(heap, buf.rawVertices, vCount * 12));
+        mix(new Uint8Array(heap, buf.indices, fCount * 12));
+        if (useClusters) mix(clusters);
+        return (h | 0xFF000000) >>> 0;
+    }
+
+    const M = {
+        HEAPU8: new Uint8Array(heap),
+        clusteredRegions: 0, // renderRegion calls that were told to use the resident clusters
+        _renderBatch() {},
+        _malloc(bytes) { top = Math.max(top, freeBase); return alloc(bytes); },
+        _free() {},
+        _uploadClusters(ptr, count) { clusters = new Uint8Array(heap, ptr, count * 48).slice(); },
+        _renderRegion(m, vCount, fCount, useClusters, outW, outH, x, y, w, h, fov, lx, ly, lz, wire, uv, normals, overlay, base, wireColor, out, stride) {
+            M.clusteredRegions += useClusters ? 1 : 0;
+            const px = new Uint32Array(heap, out, stride * h);
+            const c = digest(m, vCount, fCount, useClusters);
+            for (let row = 0; row < h; row++) px.fill(c, row * stride, row * stride + w);
+            return fCount;
+        }
+    };
+    for (const [name, ptr] of Object.entries(buf)) {
+        const exportName = name === 'pixels' ? 'Pixel' : name === 'outFB' ? 'OutFB' : name[0].toUpperCase() + name.slice(1);
+        M[`_get${exportName}Buffer`] = () => ptr;
+    }
+    return { M, buf, heap };
+}
+
+function createContext(M, state, errors) {
+    const quiet = { log() {}, warn() {}, error: (...args) => errors.push(args.join(' ')) };
+    const window = { Module: M, ENGINE: {} };
+    const context = vm.createContext({
+        window, console: quiet, setTimeout, clearTimeout, performance, TextEncoder,
+        SharedArrayBuffer: undefined // No workers: the wrapper stays on the main thread
+    });
+    const load = (file) => vm.runInContext(fs.readFileSync(path.join(ROOT, file), 'utf8'), context, { filename: file });
+    load('js/core/config.js');
+    Object.assign(window.ENGINE.Config, { MAX_VERTICES, MAX_FACES, debug: false });
+    window.ENGINE.Store = { getState: () => state };
+    load('js/core/rasterizer-wasm-wrapper.js');
+    load('js/core/offlineRenderer.js');
+    return window.ENGINE;
+}
+
+function mesh(vCount, fCount, seed) {
+    const vertices = new Float32Array(vCount * 3).map((_, i) => Math.sin(i * 0.37 + seed));
+    const indices = new Uint32Array(fCount * 3).map((_, i) => (i * 7 + seed) % vCount);
+    const clusters = [];
+    for (let f = 0; f < fCount; f += 64) {
+        clusters.push({ aabb: [-1, -1, -1, 1, 1, 1], sphere: [0, 0, 0, 1.8 + seed], startFace: f, faceCount: Math.min(64, fCount - f) });
+    }
+    return { vertices, indices, clusters };
+}
+
+const MATRIX = [1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, -3, 1];
+
+async function main() {
+    const { M, buf, heap } = createModule();
+    const live = mesh(1000, 1800, 1);
+    const state = { vertices: live.vertices, indices: live.indices, object: { clusters: live.clusters }, config: {} };
+    const errors = [];
+    const ENGINE = createContext(M, state, errors);
+    const WASM = ENGINE.RasterizerWASM, Offline = ENGINE.OfflineRenderer;
+    await WASM.init();
+    assert.ok(WASM.isReady() && WASM.hasOfflineRender(), 'wrapper initialised on the mock module');
+    // The mock has no BVH/occlusion/pipeline exports: init must say so, by name
+    assert.ok(WASM.getMissingExports().includes('_buildBVH') && !WASM.getMissingExports().includes('_renderRegion'), 'missing exports listed');
+    assert.ok(errors.length === 1 && /STALE WASM BINARY.*_bvhRaycast.*Disabled: .*mesh picking/.test(errors[0]), 'one loud stale-binary error');
+
+    // Live still, as the viewport draws it from the resident model
+    const liveFrame = () => {
+        const { rgba } = WASM.renderRegion(MATRIX, live.vertices.length / 3, live.indices.length / 3, true, 640, 480, 0, 0, 640, 480, 415, [0, 0, 1], 'SOLID', 0xFF808080, 0xFF00FFD2);
+        return Buffer.from(rgba).toString('hex');
+    };
+    const heapHoldsLive = () => {
+        assert.deepStrictEqual(new Float32Array(heap, buf.rawVertices, live.vertices.length), live.vertices, 'heap vertices are the live mesh');
+        assert.deepStrictEqual(new Uint32Array(heap, buf.indices, live.indices.length), live.indices, 'heap indices are the live mesh');
+        const resident = WASM.getResident();
+        assert.ok(resident.vertices === live.vertices && resident.indices === live.indices && resident.clusters === live.clusters, 'residency names the live mesh');
+    };
+
+    WASM.ensureResident(live);
+    const before = liveFrame();
+
+    // 1. Headless still of a foreign mesh (multi-region), then the live frame again
+    const foreign = mesh(2000, 3000, 2);
+    let spans = 0;
+    const result = await Offline.render({ width: 3000, height: 2000, matrix: MATRIX, fov: 60, ...foreign }, () => { spans++; });
+    assert.strictEqual(result.regions, 4, '3000x2000 is 2x2 regions');
+    assert.strictEqual(spans, 2000 * 2, 'one span per region row');
+    heapHoldsLive();
+    assert.strictEqual(liveFrame(), before, 'live frame unchanged after a foreign still');
+
+    // 2. A still of the live mesh leaves residency alone (no restore churn)
+    const version = WASM.getResident().version;
+    await Offline.render({ width: 800, height: 600, matrix: MATRIX }, () => {});
+    assert.strictEqual(WASM.getResident().version, version, 'live-mesh still uploads nothing new');
+    heapHoldsLive();
+
+    // 3. A failing sink still gives the heap back
+    await assert.rejects(Offline.render({ width: 400, height: 300, matrix: MATRIX, ...foreign }, () => { throw new Error('disk full'); }), /disk full/);
+    assert.ok(!Offline.isActive(), 'offline render released');
+    heapHoldsLive();
+    assert.strictEqual(liveFrame(), before, 'live frame unchanged after a failed foreign still');
+
+    // 4. The view matrix is read once: editing the caller's (or the live) matrix mid-still
+    //    must not change later regions
+    const moving = Float32Array.from(MATRIX);
+    const colours = new Set();
+    await Offline.render({ width: 3000, height: 2000, matrix: moving }, (x, y, w, rgba) => {
+        colours.add(new Uint32Array(rgba.buffer, rgba.byteOffset, 1)[0]);
+        moving[12] += 0.25; // Camera keeps moving while the still streams out
+    });
+    assert.strictEqual(colours.size, 1, 'every region rendered with the same matrix');
+
+    // 5. A caller's mesh takes clusters only from the caller: none given, none used (the live
+    //    model's clusters stay resident but describe other faces)
+    M.clusteredRegions = 0;
+    const bare = mesh(1500, 2400, 3);
+    await Offline.render({ width: 3000, height: 2000, matrix: MATRIX, vertices: bare.vertices, indices: bare.indices }, () => {});
+    assert.strictEqual(M.clusteredRegions, 0, 'no clusters for a caller mesh without clusters');
+    await Offline.render({ width: 3000, height: 2000, matrix: MATRIX, ...bare }, () => {});
+    assert.strictEqual(M.clusteredRegions, 4, "a caller mesh's own clusters are used");
+    heapHoldsLive();
+
+    console.log('offlineRenderer: all checks passed');
+}
+
+main().catch((e) => { console.error(e); process.exit(1); });